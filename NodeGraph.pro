@@ -1,5 +1,7 @@
 TEMPLATE= lib
 CONFIG += staticlib
+# std::string_view in the export readers and parsers
+CONFIG += c++17
 TARGET=lib/NodeGraph
 
 MOC_DIR=moc
@@ -7,7 +9,7 @@ OBJECTS_DIR = obj
 
 UI_DIR=ui
 UI_HEADERS_DIR=ui
-QT+= opengl gui core
+QT+= opengl gui core concurrent
 
 INC_DIR = include
 SRC_DIR = src
@@ -40,6 +42,8 @@ QMAKE_CXXFLAGS_WARN_ON += "-Wno-overloaded-virtual"
 QMAKE_CXXFLAGS_WARN_ON += "-Wno-reorder"
 QMAKE_CXXFLAGS_WARN_ON += "-Wno-switch"
 QMAKE_CXXFLAGS+= -msse -msse2 -msse3
+# keep a * b + c as two roundings so the SSE3 and scalar kernels agree bit for bit even with -march=native
+QMAKE_CXXFLAGS+= -ffp-contract=off
 macx:QMAKE_CXXFLAGS+= -arch x86_64
 
 HEADERS+=   $$INC_DIR/GraphScene.h \
@@ -47,14 +51,52 @@ HEADERS+=   $$INC_DIR/GraphScene.h \
             $$INC_DIR/GraphEdge.h \
             $$INC_DIR/NodeSocket.h \
             $$INC_DIR/Utilities.h \
-            $$INC_DIR/NodeEdit.h
+            $$INC_DIR/NodeEdit.h \
+            $$INC_DIR/StaticLayerCache.h \
+            $$INC_DIR/SpatialHash.h \
+            $$INC_DIR/CacheBudget.h \
+            $$INC_DIR/Subgraph.h \
+            $$INC_DIR/UndoJournal.h \
+            $$INC_DIR/TopologicalOrder.h \
+            $$INC_DIR/ConnectionRules.h \
+            $$INC_DIR/DataflowEngine.h \
+            $$INC_DIR/TaskScheduler.h \
+            $$INC_DIR/Port.h \
+            $$INC_DIR/VectorKernels.h \
+            $$INC_DIR/GraphProgram.h \
+            $$INC_DIR/BatchEvaluator.h \
+            $$INC_DIR/GraphExport.h \
+            $$INC_DIR/GraphSnapshot.h \
+            $$INC_DIR/ChangeStream.h \
+            $$INC_DIR/DeltaExport.h \
+            $$INC_DIR/BinaryExport.h \
+            $$INC_DIR/BinaryExportReader.h \
+            $$INC_DIR/LegacyParser.h
 
 SOURCES +=  $$SRC_DIR/GraphScene.cpp \
             $$SRC_DIR/GraphNode.cpp \
             $$SRC_DIR/GraphEdge.cpp \
             $$SRC_DIR/NodeSocket.cpp \
             $$SRC_DIR/Utilities.cpp \
-            $$SRC_DIR/NodeEdit.cpp
+            $$SRC_DIR/NodeEdit.cpp \
+            $$SRC_DIR/StaticLayerCache.cpp \
+            $$SRC_DIR/CacheBudget.cpp \
+            $$SRC_DIR/Subgraph.cpp \
+            $$SRC_DIR/UndoJournal.cpp \
+            $$SRC_DIR/TopologicalOrder.cpp \
+            $$SRC_DIR/ConnectionRules.cpp \
+            $$SRC_DIR/DataflowEngine.cpp \
+            $$SRC_DIR/TaskScheduler.cpp \
+            $$SRC_DIR/Port.cpp \
+            $$SRC_DIR/VectorKernels.cpp \
+            $$SRC_DIR/GraphProgram.cpp \
+            $$SRC_DIR/BatchEvaluator.cpp \
+            $$SRC_DIR/GraphExport.cpp \
+            $$SRC_DIR/GraphSnapshot.cpp \
+            $$SRC_DIR/ChangeStream.cpp \
+            $$SRC_DIR/DeltaExport.cpp \
+            $$SRC_DIR/BinaryExport.cpp \
+            $$SRC_DIR/LegacyParser.cpp
             
 FORMS +=    $$FORM_DIR/NodeEdit.ui
 
@@ -0,0 +1,33 @@
+TEMPLATE= app
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG += c++17
+TARGET=bin/nodegraph-bench
+
+OBJECTS_DIR = obj
+
+QT+= core
+
+INC_DIR = ../include
+SRC_DIR = .
+LIB_DIR = ../lib
+
+INCLUDEPATH +=. $$INC_DIR
+
+unix:!macx{
+    DEFINES += LINUX
+}
+macx:{
+    DEFINES += DARWIN
+}
+
+QMAKE_CXXFLAGS_WARN_ON += "-Wno-unused-parameter"
+# the same flags as the library so the kernels measured are the SSE3 ones
+QMAKE_CXXFLAGS+= -msse -msse2 -msse3 -ffp-contract=off
+macx:QMAKE_CXXFLAGS+= -arch x86_64
+
+# the library has to be built first, only the kernels are used from it
+LIBS += -L$$LIB_DIR -lNodeGraph
+PRE_TARGETDEPS += $$LIB_DIR/libNodeGraph.a
+
+SOURCES +=  $$SRC_DIR/main.cpp
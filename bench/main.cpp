@@ -0,0 +1,62 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "VectorKernels.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+/// @file main.cpp
+/// @brief Check and time the vector and matrix batch kernels
+/// @author Callum James
+/// @version 1.0
+/// @date 19/10/2026
+/// Revision History:
+/// Initial Version 19/10/2026
+/// @brief Runs VectorKernels::verify and stops with a non zero exit code if the SSE3 kernels do not match their
+/// scalar versions bit for bit, then times every kernel with VectorKernels::benchmark.
+///
+///     nodegraph-bench [values] [repeats]
+
+// used when nothing is given on the command line, a batch small enough to stay in cache
+#define DEFAULT_VALUES 4096
+#define DEFAULT_REPEATS 2000
+
+int main(int argc, char **argv)
+{
+    int values = argc > 1 ? atoi(argv[1]) : DEFAULT_VALUES;
+    int repeats = argc > 2 ? atoi(argv[2]) : DEFAULT_REPEATS;
+    if (values <= 0 || repeats <= 0)
+    {
+        fprintf(stderr,"usage: nodegraph-bench [values] [repeats]\n");
+        return 2;
+    }
+
+    printf("kernels: %s\n",VectorKernels::simd() ? "SSE3" : "scalar");
+
+    // timing kernels that give the wrong answer is pointless
+    if (!VectorKernels::verify())
+    {
+        fprintf(stderr,"verify failed: the kernels and their scalar versions differ\n");
+        return 1;
+    }
+    printf("verify: ok\n");
+
+    double rate = VectorKernels::benchmark(values,repeats);
+    printf("benchmark: %d values x %d repeats, %.1f million values per second\n",values,repeats,rate / 1.0e6);
+    return 0;
+}
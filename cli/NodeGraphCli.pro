@@ -0,0 +1,32 @@
+TEMPLATE= app
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG += c++17
+TARGET=bin/nodegraph-cli
+
+OBJECTS_DIR = obj
+
+QT+= opengl gui core concurrent
+
+INC_DIR = ../include
+SRC_DIR = .
+LIB_DIR = ../lib
+
+INCLUDEPATH +=. $$INC_DIR ../ui
+
+unix:!macx{
+    DEFINES += LINUX
+}
+macx:{
+    DEFINES += DARWIN
+}
+
+QMAKE_CXXFLAGS_WARN_ON += "-Wno-unused-parameter"
+QMAKE_CXXFLAGS+= -msse -msse2 -msse3
+macx:QMAKE_CXXFLAGS+= -arch x86_64
+
+# the library has to be built first, nothing from it that needs a display is used
+LIBS += -L$$LIB_DIR -lNodeGraph
+PRE_TARGETDEPS += $$LIB_DIR/libNodeGraph.a
+
+SOURCES +=  $$SRC_DIR/main.cpp
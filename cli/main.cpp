@@ -0,0 +1,172 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "GraphExport.h"
+#include "TaskScheduler.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QStringList>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/// @file main.cpp
+/// @brief Command line validation and export of saved graphs
+/// @author Callum James
+/// @version 1.0
+/// @date 19/10/2026
+/// Revision History:
+/// Initial Version 19/10/2026
+/// @brief Loads every graph given on the command line, as saved by GraphScene::saveGraph, validates it and writes
+/// the same #_#; string as GraphScene::collectInformation to stdout or to a file per graph. Files are processed
+/// side by side on a TaskScheduler and a summary with the time taken for each is written to stderr. No widgets are
+/// created so this runs without a display.
+
+// loads, validates and exports a single file on a worker thread
+class ExportJob : public QRunnable
+{
+public:
+    ExportJob(const QString &_fileName, const QString &_outputFile, bool _validateOnly)
+        : m_fileName(_fileName), m_outputFile(_outputFile), m_validateOnly(_validateOnly), m_ok(false), m_msecs(0) {}
+
+    void run()
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        Subgraph graph;
+        if (!graph.load(m_fileName))
+        {
+            m_error = "not a readable graph file";
+        }
+        else if (GraphExport::exportGraph(graph,&m_output,&m_error))
+        {
+            m_ok = m_validateOnly || m_outputFile.isEmpty() || write();
+        }
+        m_msecs = timer.nsecsElapsed() / 1.0e6;
+    }
+
+    QString m_fileName;
+    QString m_outputFile;
+    bool m_validateOnly;
+    bool m_ok;
+    double m_msecs;
+    std::string m_output;
+    std::string m_error;
+
+private:
+    bool write()
+    {
+        QFile file(m_outputFile);
+        if (!file.open(QIODevice::WriteOnly) || file.write(m_output.c_str(),qint64(m_output.size())) != qint64(m_output.size()))
+        {
+            m_error = "could not write "+file.fileName().toStdString();
+            return false;
+        }
+        return true;
+    }
+};
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc,argv);
+    QCoreApplication::setApplicationName("nodegraph-cli");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Validate saved node graphs and write their export");
+    parser.addHelpOption();
+    parser.addPositionalArgument("graphs","Graph files to process");
+    QCommandLineOption outputOption(QStringList()<<"o"<<"output","Write each export to <dir>/<name>.txt instead of stdout","dir");
+    QCommandLineOption threadsOption(QStringList()<<"j"<<"threads","Number of worker threads, default one per core","count","0");
+    QCommandLineOption validateOption(QStringList()<<"c"<<"check","Only validate, write no exports");
+    parser.addOption(outputOption);
+    parser.addOption(threadsOption);
+    parser.addOption(validateOption);
+    parser.process(app);
+
+    QStringList files = parser.positionalArguments();
+    if (files.isEmpty())
+    {
+        parser.showHelp(1);
+    }
+    QString outputDir = parser.value(outputOption);
+    if (!outputDir.isEmpty() && !QDir().mkpath(outputDir))
+    {
+        std::fprintf(stderr,"Could not create %s\n",qPrintable(outputDir));
+        return 1;
+    }
+
+    QElapsedTimer total;
+    total.start();
+
+    std::vector<ExportJob*> jobs;
+    TaskScheduler scheduler(parser.value(threadsOption).toInt());
+    bool validateOnly = parser.isSet(validateOption);
+    // graphs with the same name in different directories would write the same file, only the first is exported
+    QHash<QString, QString> written;
+    for (int i = 0; i < files.size(); i++)
+    {
+        QString outputFile;
+        if (!outputDir.isEmpty() && !validateOnly)
+        {
+            outputFile = QDir(outputDir).filePath(QFileInfo(files.at(i)).completeBaseName()+".txt");
+        }
+        jobs.push_back(new ExportJob(files.at(i),outputFile,validateOnly));
+        QString inputFile = QFileInfo(files.at(i)).absoluteFilePath();
+        if (!outputFile.isEmpty() && written.contains(outputFile) && written.value(outputFile) != inputFile)
+        {
+            jobs.back()->m_error = "would overwrite "+outputFile.toStdString()+", written for "+
+                                   written.value(outputFile).toStdString();
+            continue;
+        }
+        written.insert(outputFile,inputFile);
+        scheduler.addTask(jobs.back());
+    }
+    scheduler.execute();
+
+    // exports go out in the order the files were given whatever order they finished in
+    int failed = 0;
+    for (int i = 0; i < int(jobs.size()); i++)
+    {
+        ExportJob *job = jobs.at(i);
+        if (job->m_ok && outputDir.isEmpty() && !job->m_validateOnly)
+        {
+            std::fprintf(stdout,"%s\n",job->m_output.c_str());
+        }
+        if (job->m_ok)
+        {
+            std::fprintf(stderr,"ok      %9.3f ms  %s\n",job->m_msecs,qPrintable(job->m_fileName));
+        }
+        else
+        {
+            std::fprintf(stderr,"FAILED  %9.3f ms  %s: %s\n",job->m_msecs,qPrintable(job->m_fileName),job->m_error.c_str());
+            failed++;
+        }
+        delete job;
+    }
+    std::fprintf(stderr,"%d of %d graphs ok in %.3f ms on %d threads\n",int(jobs.size()) - failed,int(jobs.size()),
+                 total.nsecsElapsed() / 1.0e6,scheduler.threadCount());
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,298 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __BATCHEVALUATOR_H__
+#define __BATCHEVALUATOR_H__
+
+#include "NodeSocket.h"
+#include "Port.h"
+
+#include <QHash>
+
+#include <vector>
+
+/// @file BatchEvaluator.h
+/// @brief Runs the graph over many records at once
+/// @author Callum James
+/// @version 1.0
+/// @date 19/10/2026
+/// Revision History:
+/// Initial Version 19/10/2026
+/// @class BatchEvaluator
+/// @brief Evaluates the graph upstream of the end node over a batch of records in one pass. Columns are given to
+/// the nodes the records vary, then each node is visited once in topological order and computes its own column:
+/// a node nothing feeds repeats its value for every record, and a node with inputs combines every accepted input
+/// column with BatchOps, or runs the VectorKernels operation chosen for it with setOperation, a whole column at a
+/// time. The evaluator owns all of its columns and refers to nodes by id, looking them up in the scene and walking
+/// the graph again at the start of every run, so it stays safe to use and to destroy after the scene has been
+/// edited.
+
+class GraphScene;
+
+/// @enum BATCH_OPERATION
+/// @brief What a node does with the columns arriving on its inbound sockets. BO_COMBINE folds the accepted inputs
+/// with BatchOps, the others take the vector and matrix inputs in socket then edge order and run a VectorKernels
+/// kernel: BO_ADD adds the vectors, BO_SCALE adds the vectors then scales the sum, BO_DOT is the dot product of the
+/// first two vectors, BO_CROSS crosses the vectors left to right, BO_MULTIPLY multiplies the matrices left to right
+/// and BO_TRANSFORM transforms the first vector by each matrix in turn
+enum BATCH_OPERATION
+{
+    BO_COMBINE = 0,
+    BO_ADD,
+    BO_SCALE,
+    BO_DOT,
+    BO_CROSS,
+    BO_MULTIPLY,
+    BO_TRANSFORM
+};
+
+/// @struct BatchOperation
+/// @brief The operation chosen for a node
+struct BatchOperation
+{
+    /// @brief The operation
+    BATCH_OPERATION m_operation;
+    /// @brief The scale of BO_SCALE
+    double m_scale;
+};
+
+/// @namespace BatchOps
+/// @brief How a node combines the columns arriving on its inbound sockets, in socket then edge order. Numbers are
+/// added, booleans are or'd, strings are joined, vectors are added and matrices are multiplied, the running total
+/// on the left
+namespace BatchOps
+{
+    /// @brief Combine a column into a running total, record by record
+    /// @param [in,out] _total std::vector<int>* - the running total
+    /// @param [in] _input std::vector<int> - the column to combine, the same length as the total
+    void combine(std::vector<int> *_total, const std::vector<int> &_input);
+    /// @brief Combine a column into a running total, record by record
+    void combine(std::vector<float> *_total, const std::vector<float> &_input);
+    /// @brief Combine a column into a running total, record by record
+    void combine(std::vector<double> *_total, const std::vector<double> &_input);
+    /// @brief Combine a column into a running total, record by record
+    void combine(std::vector<bool> *_total, const std::vector<bool> &_input);
+    /// @brief Combine a column into a running total, record by record
+    void combine(std::vector<std::string> *_total, const std::vector<std::string> &_input);
+    /// @brief Combine a column into a running total, record by record
+    void combine(std::vector<PortVector> *_total, const std::vector<PortVector> &_input);
+    /// @brief Combine a column into a running total, record by record
+    void combine(std::vector<PortMatrix> *_total, const std::vector<PortMatrix> &_input);
+}
+
+class ColumnBase
+{
+public:
+    /// @brief ctr
+    /// @param [in] _type PORT_TYPE - the native type of the values
+    explicit ColumnBase(PORT_TYPE _type) : m_type(_type) {}
+    /// @brief dtr
+    virtual ~ColumnBase() {}
+
+    /// @brief Get the native type of the values
+    /// @returns PORT_TYPE
+    PORT_TYPE type() const {return m_type;}
+    /// @brief Get the number of records
+    /// @returns int
+    virtual int rows() const = 0;
+    /// @brief Copy the values as numbers, used for widening between numeric columns
+    /// @param [out] _numbers std::vector<double>* - the vector to write to, 0 for non numeric columns
+    virtual void toNumbers(std::vector<double> *_numbers) const = 0;
+    /// @brief Replace the values with those of another column, converted to this columns type
+    /// @param [in] _source ColumnBase* - a column of the same type or a narrower number
+    virtual void assign(const ColumnBase *_source) = 0;
+    /// @brief Combine the values of another column into these with BatchOps
+    /// @param [in] _source ColumnBase* - a column of the same type or a narrower number
+    virtual void combine(const ColumnBase *_source) = 0;
+    /// @brief Replace the values with the value of a port repeated
+    /// @param [in] _port PortBase* - the port holding the value, a default value is used if it is another type
+    /// @param [in] _rows int - the number of records
+    virtual void broadcast(const PortBase *_port, int _rows) = 0;
+
+    /// @brief Create an empty column
+    /// @param [in] _type PORT_TYPE - the type of the values
+    /// @returns ColumnBase* - owned by the caller, NULL for PT_NONE and PT_ANY
+    static ColumnBase *create(PORT_TYPE _type);
+
+private:
+    /// @brief The native type of the values
+    PORT_TYPE m_type;
+};
+
+template <typename T>
+class Column : public ColumnBase
+{
+public:
+    /// @brief ctr
+    Column() : ColumnBase(PortTraits<T>::type()) {}
+
+    /// @brief Get the values
+    /// @returns std::vector<T>
+    const std::vector<T> &values() const {return m_values;}
+    /// @brief Set the values
+    /// @param [in] _values std::vector<T> - one value per record
+    void setValues(const std::vector<T> &_values) {m_values = _values;}
+    /// @brief Swap the values with a vector, to hand over values computed elsewhere without copying
+    /// @param [in,out] _values std::vector<T>* - one value per record
+    void swapValues(std::vector<T> *_values) {m_values.swap(*_values);}
+
+    int rows() const {return int(m_values.size());}
+    void toNumbers(std::vector<double> *_numbers) const
+    {
+        _numbers->resize(m_values.size());
+        for (int i = 0; i < int(m_values.size()); i++)
+        {
+            (*_numbers)[i] = PortTraits<T>::toNumber(m_values[i]);
+        }
+    }
+    void assign(const ColumnBase *_source)
+    {
+        if (_source->type() == type())
+        {
+            m_values = static_cast<const Column<T>*>(_source)->values();
+            return;
+        }
+        // only numeric widening gets past accepts
+        std::vector<double> numbers;
+        _source->toNumbers(&numbers);
+        m_values.resize(numbers.size());
+        for (int i = 0; i < int(numbers.size()); i++)
+        {
+            m_values[i] = PortTraits<T>::fromNumber(numbers[i]);
+        }
+    }
+    void combine(const ColumnBase *_source)
+    {
+        if (_source->type() == type())
+        {
+            BatchOps::combine(&m_values,static_cast<const Column<T>*>(_source)->values());
+            return;
+        }
+        Column<T> widened;
+        widened.assign(_source);
+        BatchOps::combine(&m_values,widened.values());
+    }
+    void broadcast(const PortBase *_port, int _rows)
+    {
+        T value = T();
+        if (_port && _port->type() == type())
+        {
+            value = static_cast<const Port<T>*>(_port)->value();
+        }
+        m_values.assign(_rows,value);
+    }
+
+private:
+    /// @brief One value per record
+    std::vector<T> m_values;
+};
+
+class BatchEvaluator
+{
+public:
+    /// @brief ctr
+    /// @param [in] _scene GraphScene* - the scene holding the graph, nodes are looked up in it on every run
+    /// @param [in] _end GraphNode* - the end node, the batch covers everything upstream of it
+    BatchEvaluator(GraphScene *_scene, GraphNode *_end);
+    /// @brief dtr, frees every column
+    ~BatchEvaluator();
+
+    /// @brief Give a node a column of values, one per record, replacing what it would compute
+    /// @param [in] _node GraphNode* - the node, must carry values of type T
+    /// @param [in] _column std::vector<T> - the values
+    /// @returns bool - false if the node carries another type
+    template <typename T>
+    bool setInput(GraphNode *_node, const std::vector<T> &_column)
+    {
+        if (!_node || valueType(_node) != PortTraits<T>::type()) return false;
+        Column<T> *column = new Column<T>();
+        column->setValues(_column);
+        setInputColumn(_node->id(),column);
+        return true;
+    }
+
+    /// @brief Choose what a node does with its inputs, BO_COMBINE until this is called
+    /// @param [in] _node GraphNode* - the node
+    /// @param [in] _operation BATCH_OPERATION - the operation
+    /// @param [in] _scale double - the scale of BO_SCALE
+    /// @returns bool - false if the node does not carry what the operation gives, a double for BO_DOT, a matrix for
+    /// BO_MULTIPLY and a vector for the others
+    bool setOperation(GraphNode *_node, BATCH_OPERATION _operation, double _scale = 1.0);
+
+    /// @brief Evaluate every node upstream of the end node for every record
+    /// @returns bool - false if the end node has been removed or the input columns differ in length
+    bool run();
+
+    /// @brief Get the column of a node after a run
+    /// @param [in] _node GraphNode* - the node
+    /// @returns std::vector<T>* - NULL if the node was not in the last run or carries another type
+    template <typename T>
+    const std::vector<T> *output(GraphNode *_node) const
+    {
+        if (!_node) return NULL;
+        ColumnBase *column = m_outputs.value(_node->id(),NULL);
+        if (!column || column->type() != PortTraits<T>::type()) return NULL;
+        return &static_cast<const Column<T>*>(column)->values();
+    }
+
+    /// @brief Get the number of records in the last run
+    /// @returns int
+    int rows() const {return m_rows;}
+    /// @brief Free every column and forget the inputs and operations
+    void clear();
+
+private:
+    /// @brief The scene holding the graph
+    GraphScene *m_scene;
+    /// @brief Id of the end node
+    quint32 m_end;
+    /// @brief Columns given by the caller, keyed by node id
+    QHash<quint32, ColumnBase*> m_inputs;
+    /// @brief Operations chosen for nodes, keyed by node id
+    QHash<quint32, BatchOperation> m_operations;
+    /// @brief Columns computed by the last run, keyed by node id
+    QHash<quint32, ColumnBase*> m_outputs;
+    /// @brief Number of records
+    int m_rows;
+
+    /// @brief Store a caller column, replacing any the node already had
+    /// @param [in] _id quint32 - id of the node
+    /// @param [in] _column ColumnBase* - the column, ownership passes to the evaluator
+    void setInputColumn(quint32 _id, ColumnBase *_column);
+    /// @brief Free the columns of the last run
+    void clearOutputs();
+    /// @brief Compute the column of a node with the operation chosen for it
+    /// @param [in] _node GraphNode* - the node, everything upstream of it already computed
+    /// @param [in] _operation BatchOperation - the operation
+    /// @param [out] _column ColumnBase* - the column of the node, of the type the operation gives
+    /// @returns bool - false if the node lacks the inputs the operation needs
+    bool operate(GraphNode *_node, const BatchOperation &_operation, ColumnBase *_column) const;
+    /// @brief Get the type of value an operation gives
+    /// @param [in] _operation BATCH_OPERATION - the operation
+    /// @returns PORT_TYPE - PT_ANY for BO_COMBINE, which gives the type of the node
+    static PORT_TYPE operationType(BATCH_OPERATION _operation);
+    /// @brief Get the port holding the value of a node, its first outbound port
+    /// @param [in] _node GraphNode* - the node
+    /// @returns PortBase* - NULL if the node has none
+    static PortBase *valuePort(GraphNode *_node);
+    /// @brief Get the type of value a node carries
+    /// @param [in] _node GraphNode* - the node
+    /// @returns PORT_TYPE - PT_NONE if the node has no value port
+    static PORT_TYPE valueType(GraphNode *_node);
+};
+
+#endif /* __BATCHEVALUATOR_H__ */
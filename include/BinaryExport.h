@@ -0,0 +1,62 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __BINARYEXPORT_H__
+#define __BINARYEXPORT_H__
+
+#include "GraphNode.h"
+
+#include <QByteArray>
+
+#include <vector>
+
+/// @file BinaryExport.h
+/// @brief Writing the graph in the length prefixed binary export format
+/// @author Callum James
+/// @version 1.0
+/// @date 19/10/2026
+/// Revision History:
+/// Initial Version 19/10/2026
+/// @namespace BinaryExport
+/// @brief An alternative to the #_#; string that needs no tokenising and carries any character in a name. The
+/// layout, all integers little endian:
+///  - header: magic 'NGBX', version u16, reserved u16, node count u32, edge count u32, arena size u32
+///  - node table, 40 bytes a node: id u32, value type u8, flags u8, node type u16, then offset u32 and length u32
+///    into the arena of the value type name, node type name, name and short name
+///  - edge table, 12 bytes an edge: source node index u32, destination node index u32, source socket u16,
+///    destination socket u16
+///  - string arena, every string once, not terminated
+/// BinaryExportReader.h reads it without copying.
+
+/// @brief Identifies the format, 'NGBX' read as a little endian u32
+#define BINARY_EXPORT_MAGIC 0x5842474E
+#define BINARY_EXPORT_VERSION 1
+#define BINARY_EXPORT_HEADER_SIZE 20
+#define BINARY_EXPORT_NODE_SIZE 40
+#define BINARY_EXPORT_EDGE_SIZE 12
+/// @brief Node flag set on the end node
+#define BINARY_EXPORT_FLAG_END 0x1
+
+namespace BinaryExport
+{
+    /// @brief Write nodes and every edge running between two of them
+    /// @param [in] _nodes std::vector<GraphNode*> - the nodes in the order they are written
+    /// @param [out] _data QByteArray* - the buffer to write to, replacing anything in it
+    void write(const std::vector<GraphNode*> &_nodes, QByteArray *_data);
+}
+
+#endif /* __BINARYEXPORT_H__ */
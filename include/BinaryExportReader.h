@@ -0,0 +1,198 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __BINARYEXPORTREADER_H__
+#define __BINARYEXPORTREADER_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/// @file BinaryExportReader.h
+/// @brief Reading the binary export without copying
+/// @author Callum James
+/// @version 1.0
+/// @date 19/10/2026
+/// Revision History:
+/// Initial Version 19/10/2026
+/// @class BinaryExportReader
+/// @brief Header only so a consumer can read the format of BinaryExport.h without linking the library or Qt.
+/// The buffer is checked once when the reader is made, every table entry and string has to lie inside it, after
+/// which records are decoded on demand and strings are std::string_views into the buffer. The buffer has to
+/// outlive the reader and every view taken from it. Needs C++17 for std::string_view.
+
+class BinaryExportReader
+{
+public:
+    /// @struct Node
+    /// @brief A node record
+    struct Node
+    {
+        /// @brief Id of the node in the scene
+        std::uint32_t m_id;
+        /// @brief Top level type, a VALUE_TYPE
+        std::uint8_t m_valueType;
+        /// @brief Bottom level type, a NODE_TYPE
+        std::uint16_t m_nodeType;
+        /// @brief If this is the end node
+        bool m_endNode;
+        /// @brief Name of the top level type as in the #_#; export
+        std::string_view m_valueTypeName;
+        /// @brief Name of the bottom level type as in the #_#; export
+        std::string_view m_nodeTypeName;
+        /// @brief Name of the node
+        std::string_view m_name;
+        /// @brief Short name of the node
+        std::string_view m_shortName;
+    };
+
+    /// @struct Edge
+    /// @brief An edge record
+    struct Edge
+    {
+        /// @brief Index of the source node in the node table
+        std::uint32_t m_sourceNode;
+        /// @brief Index of the destination node in the node table
+        std::uint32_t m_destinationNode;
+        /// @brief Index of the outbound socket on the source node
+        std::uint16_t m_sourceSocket;
+        /// @brief Index of the inbound socket on the destination node
+        std::uint16_t m_destinationSocket;
+    };
+
+    /// @brief ctr, checks the whole buffer
+    /// @param [in] _data const char* - the buffer
+    /// @param [in] _size std::size_t - size of the buffer in bytes
+    BinaryExportReader(const char *_data, std::size_t _size) :
+        m_data(reinterpret_cast<const unsigned char*>(_data)), m_numNodes(0), m_numEdges(0), m_nodes(NULL),
+        m_edges(NULL), m_arena(NULL), m_arenaSize(0), m_valid(false)
+    {
+        if (!m_data || _size < HEADER_SIZE || u32(m_data) != MAGIC || u16(m_data + 4) != VERSION) return;
+
+        std::uint64_t numNodes = u32(m_data + 8);
+        std::uint64_t numEdges = u32(m_data + 12);
+        std::uint64_t arenaSize = u32(m_data + 16);
+        if (HEADER_SIZE + numNodes * NODE_SIZE + numEdges * EDGE_SIZE + arenaSize != _size) return;
+
+        m_numNodes = std::uint32_t(numNodes);
+        m_numEdges = std::uint32_t(numEdges);
+        m_nodes = m_data + HEADER_SIZE;
+        m_edges = m_nodes + numNodes * NODE_SIZE;
+        m_arena = m_edges + numEdges * EDGE_SIZE;
+        m_arenaSize = std::uint32_t(arenaSize);
+
+        for (std::uint32_t i = 0; i < m_numNodes; i++)
+        {
+            const unsigned char *node = m_nodes + std::size_t(i) * NODE_SIZE;
+            for (int s = 0; s < 4; s++)
+            {
+                std::uint64_t offset = u32(node + 8 + s * 8);
+                std::uint64_t length = u32(node + 12 + s * 8);
+                if (offset + length > m_arenaSize) return;
+            }
+        }
+        for (std::uint32_t i = 0; i < m_numEdges; i++)
+        {
+            const unsigned char *edge = m_edges + std::size_t(i) * EDGE_SIZE;
+            if (u32(edge) >= m_numNodes || u32(edge + 4) >= m_numNodes) return;
+        }
+        m_valid = true;
+    }
+
+    /// @brief Returns if the buffer holds a complete export, nothing else may be called if not
+    /// @returns bool
+    bool valid() const {return m_valid;}
+    /// @brief Get the number of nodes
+    /// @returns std::uint32_t
+    std::uint32_t numNodes() const {return m_numNodes;}
+    /// @brief Get the number of edges
+    /// @returns std::uint32_t
+    std::uint32_t numEdges() const {return m_numEdges;}
+
+    /// @brief Get a node
+    /// @param [in] _index std::uint32_t - index in the node table, less than numNodes
+    /// @returns Node
+    Node node(std::uint32_t _index) const
+    {
+        const unsigned char *node = m_nodes + std::size_t(_index) * NODE_SIZE;
+        Node record;
+        record.m_id = u32(node);
+        record.m_valueType = node[4];
+        record.m_endNode = (node[5] & FLAG_END) != 0;
+        record.m_nodeType = u16(node + 6);
+        record.m_valueTypeName = string(node + 8);
+        record.m_nodeTypeName = string(node + 16);
+        record.m_name = string(node + 24);
+        record.m_shortName = string(node + 32);
+        return record;
+    }
+
+    /// @brief Get an edge
+    /// @param [in] _index std::uint32_t - index in the edge table, less than numEdges
+    /// @returns Edge
+    Edge edge(std::uint32_t _index) const
+    {
+        const unsigned char *edge = m_edges + std::size_t(_index) * EDGE_SIZE;
+        Edge record;
+        record.m_sourceNode = u32(edge);
+        record.m_destinationNode = u32(edge + 4);
+        record.m_sourceSocket = u16(edge + 8);
+        record.m_destinationSocket = u16(edge + 10);
+        return record;
+    }
+
+private:
+    // these match the defines in BinaryExport.h, repeated so this header stands alone
+    static const std::uint32_t MAGIC = 0x5842474E;
+    static const std::uint16_t VERSION = 1;
+    static const std::size_t HEADER_SIZE = 20;
+    static const std::size_t NODE_SIZE = 40;
+    static const std::size_t EDGE_SIZE = 12;
+    static const std::uint8_t FLAG_END = 0x1;
+
+    /// @brief Start of the buffer
+    const unsigned char *m_data;
+    /// @brief Number of nodes
+    std::uint32_t m_numNodes;
+    /// @brief Number of edges
+    std::uint32_t m_numEdges;
+    /// @brief Start of the node table
+    const unsigned char *m_nodes;
+    /// @brief Start of the edge table
+    const unsigned char *m_edges;
+    /// @brief Start of the string arena
+    const unsigned char *m_arena;
+    /// @brief Size of the string arena
+    std::uint32_t m_arenaSize;
+    /// @brief If the buffer passed the checks
+    bool m_valid;
+
+    /// @brief Read a little endian u16
+    static std::uint16_t u16(const unsigned char *_in) {return std::uint16_t(_in[0] | (_in[1] << 8));}
+    /// @brief Read a little endian u32
+    static std::uint32_t u32(const unsigned char *_in)
+    {
+        return std::uint32_t(_in[0]) | (std::uint32_t(_in[1]) << 8) | (std::uint32_t(_in[2]) << 16) | (std::uint32_t(_in[3]) << 24);
+    }
+    /// @brief View the arena string an offset and length pair refers to
+    std::string_view string(const unsigned char *_in) const
+    {
+        return std::string_view(reinterpret_cast<const char*>(m_arena) + u32(_in),u32(_in + 4));
+    }
+};
+
+#endif /* __BINARYEXPORTREADER_H__ */
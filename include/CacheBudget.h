@@ -0,0 +1,115 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __CACHEBUDGET_H__
+#define __CACHEBUDGET_H__
+
+#include <QObject>
+#include <QGraphicsView>
+#include <QGraphicsItem>
+#include <QHash>
+#include <QSet>
+
+#include <list>
+
+/// @file CacheBudget.h
+/// @brief Scene wide budget for the pixmaps QGraphicsItem caches its items in
+/// @author Callum James
+/// @version 1.0
+/// @date 19/10/2026
+/// Revision History:
+/// Initial Version 19/10/2026
+/// @class CacheBudget
+/// @brief Chooses the cache mode of each registered item from its size on screen, and keeps the estimated
+/// size of all item pixmaps under a budget. Items are kept in least recently touched order and when the budget is
+/// exceeded the oldest items have their cache turned off, which frees their pixmap. Recency is by touch, not by
+/// paint: the scene touches the items under the viewport when the view scrolls or zooms and an item when it is
+/// materialized or resized, so an item repainted in place without any of these still ages.
+
+class CacheBudget : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// @brief ctr
+    /// @param [in] _view QGraphicsView* - the view the items are shown in
+    /// @param [in] _parent QObject* - the parent object
+    explicit CacheBudget(QGraphicsView *_view, QObject *_parent = 0);
+    /// @brief dtr
+    ~CacheBudget();
+
+    /// @brief Set the maximum number of bytes all item pixmaps may use
+    /// @param [in] _bytes qint64 - the budget in bytes
+    void setBudget(qint64 _bytes);
+    /// @brief Get the maximum number of bytes all item pixmaps may use
+    /// @returns qint64
+    qint64 budget() const {return m_budget;}
+    /// @brief Get the estimated number of bytes currently used by item pixmaps
+    /// @returns qint64
+    qint64 usage() const {return m_usage;}
+
+    /// @brief Mark an item as seen, its cache mode is re-evaluated when control returns to the event loop
+    /// @param [in] _item QGraphicsItem* - the item that is visible or has changed
+    void touch(QGraphicsItem *_item);
+    /// @brief Turn off the cache of an item and stop tracking it, used when it leaves the scene
+    /// @param [in] _item QGraphicsItem* - the item to release
+    void release(QGraphicsItem *_item);
+
+private slots:
+    /// @brief Choose the cache mode of every touched item then evict until under budget
+    void enforce();
+
+private:
+    /// @brief Book keeping for a tracked item
+    struct Entry
+    {
+        /// @brief Position in the recency list
+        std::list<QGraphicsItem*>::iterator m_recent;
+        /// @brief Estimated size of the items pixmap in bytes
+        qint64 m_bytes;
+        /// @brief Size given to the item cache, only used by ItemCoordinateCache
+        QSize m_logicalSize;
+        /// @brief If the item is in the recency list, items without a cache are not
+        bool m_cached;
+    };
+
+    /// @brief The view the items are shown in
+    QGraphicsView *m_view;
+    /// @brief Maximum bytes for all item pixmaps
+    qint64 m_budget;
+    /// @brief Estimated bytes used by all item pixmaps
+    qint64 m_usage;
+    /// @brief Every tracked item
+    QHash<QGraphicsItem*, Entry> m_entries;
+    /// @brief Cached items, most recently touched first
+    std::list<QGraphicsItem*> m_recent;
+    /// @brief Items touched since the last enforce
+    QSet<QGraphicsItem*> m_pending;
+    /// @brief If an enforce is already queued
+    bool m_scheduled;
+
+    /// @brief Choose and apply the cache mode for an item
+    /// @param [in] _item QGraphicsItem* - the item to update
+    /// @param [in] _entry Entry& - the items book keeping
+    void applyMode(QGraphicsItem *_item, Entry &_entry);
+    /// @brief Turn off the cache for an item and take it out of the recency list
+    /// @param [in] _item QGraphicsItem* - the item to evict
+    /// @param [in] _entry Entry& - the items book keeping
+    void evict(QGraphicsItem *_item, Entry &_entry);
+};
+
+#endif /* __CACHEBUDGET_H__ */
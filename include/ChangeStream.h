@@ -0,0 +1,151 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __CHANGESTREAM_H__
+#define __CHANGESTREAM_H__
+
+#include "UndoJournal.h"
+
+#include <QObject>
+#include <QHash>
+#include <QPair>
+#include <QPointF>
+
+#include <string>
+#include <vector>
+
+/// @file ChangeStream.h
+/// @brief Batched notifications of every change made to the graph
+/// @author Callum James
+/// @version 1.0
+/// @date 19/10/2026
+/// Revision History:
+/// Initial Version 19/10/2026
+/// @class ChangeStream
+/// @brief Collects the changes made to the graph and emits them as one batch when control returns to the event
+/// loop, so a consumer can keep its own copy of the graph up to date without polling collectInformation. Changes
+/// refer to nodes by their stable id. Within a batch a node is reported moved or renamed at most once with its
+/// latest state, a node added then removed is left out, and an edge connected then disconnected cancels out.
+
+/// @enum CHANGE_TYPE
+/// @brief What a change did
+enum CHANGE_TYPE
+{
+    CT_NODE_ADDED = 0,
+    CT_NODE_REMOVED,
+    CT_NODE_RENAMED,
+    CT_NODE_MOVED,
+    CT_EDGE_CONNECTED,
+    CT_EDGE_DISCONNECTED
+};
+
+/// @struct GraphChange
+/// @brief A single change, only the fields its type needs are set
+struct GraphChange
+{
+    /// @brief What the change did
+    CHANGE_TYPE m_type;
+    /// @brief Id of the node for node changes
+    quint32 m_node;
+    /// @brief Top level type of an added node
+    VALUE_TYPE m_valueType;
+    /// @brief Bottom level type of an added node
+    NODE_TYPE m_nodeType;
+    /// @brief Position of an added or moved node
+    QPointF m_point;
+    /// @brief Name of an added or renamed node
+    std::string m_name;
+    /// @brief Short name of an added or renamed node
+    std::string m_shortName;
+    /// @brief The edge for edge changes
+    JournalEdge m_edge;
+};
+
+class ChangeStream : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// @brief Key of an edge, the node ids then the socket indices
+    typedef QPair<quint64, quint32> EdgeKey;
+
+    /// @brief ctr
+    /// @param [in] _parent QObject* - the parent object
+    explicit ChangeStream(QObject *_parent = 0);
+
+    /// @brief Record a new node
+    /// @param [in] _node GraphNode* - the node, it must already have its id
+    void nodeAdded(GraphNode *_node);
+    /// @brief Record a removed node
+    /// @param [in] _id quint32 - id of the node
+    void nodeRemoved(quint32 _id);
+    /// @brief Record a name change
+    /// @param [in] _node GraphNode* - the node holding its new names
+    void nodeRenamed(GraphNode *_node);
+    /// @brief Record a node that may have moved, nothing is recorded if its position is unchanged
+    /// @param [in] _node GraphNode* - the node
+    void nodeMoved(GraphNode *_node);
+    /// @brief Record a new edge
+    /// @param [in] _edge JournalEdge - the edge by node ids and socket indices
+    void edgeConnected(const JournalEdge &_edge);
+    /// @brief Record a removed edge
+    /// @param [in] _edge JournalEdge - the edge by node ids and socket indices
+    void edgeDisconnected(const JournalEdge &_edge);
+    /// @brief Make the key of an edge
+    /// @param [in] _edge JournalEdge - the edge
+    /// @returns EdgeKey
+    static EdgeKey edgeKey(const JournalEdge &_edge);
+
+public slots:
+    /// @brief Emit the pending changes, queued for when control returns to the event loop and called directly by
+    /// readers that must see every change made so far
+    void flush();
+
+signals:
+    /// @brief Every change since the last batch, in the order they happened
+    /// @param [in] _changes std::vector<GraphChange> - the changes
+    void changed(const std::vector<GraphChange> &_changes);
+
+private:
+    /// @brief Changes since the last batch, including dropped ones
+    std::vector<GraphChange> m_pending;
+    /// @brief If each pending change still has to be sent
+    std::vector<bool> m_live;
+    /// @brief Pending additions by node id
+    QHash<quint32, int> m_added;
+    /// @brief Pending moves by node id
+    QHash<quint32, int> m_moved;
+    /// @brief Pending renames by node id
+    QHash<quint32, int> m_renamed;
+    /// @brief Pending edge connections by edge
+    QHash<EdgeKey, int> m_connected;
+    /// @brief Last reported position of each node, to tell a move from a resize
+    QHash<quint32, QPointF> m_positions;
+    /// @brief If a flush is already queued
+    bool m_scheduled;
+
+    /// @brief Queue a change and make sure a flush is coming
+    /// @param [in] _change GraphChange - the change
+    /// @returns int - index of the change in m_pending
+    int push(const GraphChange &_change);
+    /// @brief Drop a pending change
+    /// @param [in] _index QHash<quint32,int> - the map holding its index
+    /// @param [in] _id quint32 - the node id
+    void drop(QHash<quint32, int> *_index, quint32 _id);
+};
+
+#endif /* __CHANGESTREAM_H__ */
@@ -0,0 +1,58 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __CONNECTIONRULES_H__
+#define __CONNECTIONRULES_H__
+
+#include "GraphNode.h"
+
+/// @file ConnectionRules.h
+/// @brief Which nodes may be connected to which
+/// @author Callum James
+/// @version 1.0
+/// @date 19/10/2026
+/// Revision History:
+/// Initial Version 19/10/2026
+/// @namespace ConnectionRules
+/// @brief Rules deciding if an edge may be created between two sockets. The allowed source types for each pair of
+/// source and destination VALUE_TYPE are held in a constant table of NODE_TYPE bit masks, so a check is a single
+/// lookup and cheap enough to run on every mouse move while an edge is being dragged.
+
+/// @namespace ConnectionRules
+/// @brief Functions checking if two nodes may be connected
+namespace ConnectionRules
+{
+    /// @brief Returns if a node of one type may feed a node of another
+    /// @param [in] _sourceValue VALUE_TYPE - the top level type of the source node
+    /// @param [in] _sourceType NODE_TYPE - the bottom level type of the source node
+    /// @param [in] _destinationValue VALUE_TYPE - the top level type of the destination node
+    /// @returns bool
+    bool compatible(VALUE_TYPE _sourceValue, NODE_TYPE _sourceType, VALUE_TYPE _destinationValue);
+    /// @brief Returns if a source node may feed a destination node
+    /// @param [in] _source GraphNode* - the node the edge leaves
+    /// @param [in] _destination GraphNode* - the node the edge enters
+    /// @returns bool
+    bool compatible(GraphNode *_source, GraphNode *_destination);
+    /// @brief Returns if the creation menus offer a bottom level type for a top level type, the end node is never
+    /// offered
+    /// @param [in] _value VALUE_TYPE - the top level type
+    /// @param [in] _type NODE_TYPE - the bottom level type
+    /// @returns bool
+    bool offered(VALUE_TYPE _value, NODE_TYPE _type);
+}
+
+#endif /* __CONNECTIONRULES_H__ */
@@ -0,0 +1,96 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __DATAFLOWENGINE_H__
+#define __DATAFLOWENGINE_H__
+
+#include "GraphNode.h"
+#include "GraphProgram.h"
+#include "TaskScheduler.h"
+
+#include <string>
+#include <vector>
+
+/// @file DataflowEngine.h
+/// @brief Keeps the result of every node and recomputes only what an edit affects
+/// @author Callum James
+/// @version 1.0
+/// @date 19/10/2026
+/// Revision History:
+/// Initial Version 19/10/2026
+/// @class DataflowEngine
+/// @brief Evaluates a node through a GraphProgram holding the last result of every node upstream of it along with
+/// a dirty flag. Changing a node, or an edge into a node in the program, marks its slot and every slot reading it
+/// dirty, so a clean slot always has clean inputs. Edges into nodes outside the program change nothing. Asking for
+/// a result executes only the dirty slots and reuses the rest, lowering the program again first if an edge into it
+/// was added or removed, keeping the results of the slots that are still clean. The end node's result is the
+/// export of everything upstream of it, each node once and after every node feeding it. Given a TaskScheduler,
+/// large batches of dirty slots run independent branches on its worker threads.
+
+class DataflowEngine
+{
+public:
+    /// @brief ctr
+    DataflowEngine();
+
+    /// @brief Set the scheduler used to recompute independent branches in parallel
+    /// @param [in] _scheduler TaskScheduler* - the scheduler, NULL computes everything on the calling thread
+    void setScheduler(TaskScheduler *_scheduler) {m_scheduler = _scheduler;}
+
+    /// @brief Mark a node and everything downstream of it dirty, used when its name or type changes
+    /// @param [in] _node GraphNode* - the changed node
+    void nodeChanged(GraphNode *_node);
+    /// @brief Mark the destination of an edge and everything downstream of it dirty, used when the edge is added or removed
+    /// @param [in] _edge GraphEdge* - the changed edge
+    void edgeChanged(GraphEdge *_edge);
+    /// @brief Forget a node, used when it leaves the scene
+    /// @param [in] _node GraphNode* - the removed node
+    void forget(GraphNode *_node);
+    /// @brief Forget every result
+    void clear() {m_program.invalidate();}
+
+    /// @brief Get the result of a node, recomputing any dirty node it depends on
+    /// @param [in] _node GraphNode* - the node to evaluate
+    /// @returns NodeResult
+    const NodeResult &evaluate(GraphNode *_node);
+
+    /// @brief Get the number of node results recomputed since the counters were reset
+    /// @returns int
+    int recomputedCount() const {return m_recomputed;}
+    /// @brief Get the number of clean node results reused since the counters were reset
+    /// @returns int
+    int reusedCount() const {return m_reused;}
+    /// @brief Set both counters back to zero
+    void resetCounters() {m_recomputed = 0; m_reused = 0;}
+
+    /// @brief Get every node upstream of a node, each once and after every node feeding it, in socket and edge order
+    /// @param [in] _node GraphNode* - the node to start from, not included in the order
+    /// @param [out] _order std::vector<GraphNode*>* - the vector to write the order to
+    static void upstreamOrder(GraphNode *_node, std::vector<GraphNode*> *_order);
+
+private:
+    /// @brief Number of results recomputed
+    int m_recomputed;
+    /// @brief Number of results reused
+    int m_reused;
+    /// @brief Runs large recomputes across worker threads, may be NULL
+    TaskScheduler *m_scheduler;
+    /// @brief The compiled graph upstream of the evaluated node
+    GraphProgram m_program;
+};
+
+#endif /* __DATAFLOWENGINE_H__ */
@@ -0,0 +1,184 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __DELTAEXPORT_H__
+#define __DELTAEXPORT_H__
+
+#include "ChangeStream.h"
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QByteArray>
+
+#include <string>
+#include <vector>
+
+/// @file DeltaExport.h
+/// @brief Exporting only what changed since the consumers last export
+/// @author Callum James
+/// @version 1.0
+/// @date 19/10/2026
+/// Revision History:
+/// Initial Version 19/10/2026
+/// @class DeltaExport
+/// @brief Remembers the node records, their order and the edges between them of the last export under a revision
+/// number. A consumer passes back the revision it holds and gets only the records and edges that changed since,
+/// each record with its position in the #_#; export, along with the new revision. If the revision does not match,
+/// everything is sent again as a full resync. The typed changes of a ChangeStream decide what is looked at again,
+/// a rename only re-records the renamed node and only edges into exported nodes walk the graph upstream of the end
+/// node again, nodes that were already exported are never re-recorded by the walk. A count of every token in the
+/// export is kept so the check for repeated tokens only looks at the records that changed.
+
+class GraphScene;
+
+/// @struct DeltaRecord
+/// @brief An exported node
+struct DeltaRecord
+{
+    /// @brief Id of the node
+    quint32 m_id;
+    /// @brief Index of the record in the export, member nodes first then everything upstream of the end node
+    int m_position;
+    /// @brief The node as it appears in the #_#; export, value type, type, name, short name then --, empty if
+    /// only the position changed
+    std::string m_record;
+};
+
+/// @struct ExportDelta
+/// @brief The changes between two exports
+struct ExportDelta
+{
+    /// @brief Revision the changes apply to, 0 for a full resync
+    quint64 m_baseRevision;
+    /// @brief Revision after the changes
+    quint64 m_revision;
+    /// @brief Records added, every record on a full resync
+    std::vector<DeltaRecord> m_added;
+    /// @brief Records that changed, with their position
+    std::vector<DeltaRecord> m_modified;
+    /// @brief Records that only changed position
+    std::vector<DeltaRecord> m_moved;
+    /// @brief Ids of nodes no longer exported
+    std::vector<quint32> m_removed;
+    /// @brief Edges now leading into an exported node or the end node, every such edge on a full resync
+    std::vector<JournalEdge> m_connected;
+    /// @brief Edges no longer leading into an exported node or the end node
+    std::vector<JournalEdge> m_disconnected;
+
+    /// @brief Returns if this replaces everything the consumer holds
+    /// @returns bool
+    bool full() const {return m_baseRevision == 0;}
+    /// @brief Format the delta for the wizard, #D#;base;revision; then -;id; for each removed node, +;id;position;
+    /// and a record for each added node, *;id;position; and a record for each modified node, >;id;position; for each
+    /// moved node, =;source;socket;destination;socket; for each connected edge and !; with the same fields for each
+    /// disconnected edge, closed by #D#;
+    /// Dropping the removed records then placing every listed record at its position gives the order of the export.
+    /// @returns std::string
+    std::string toString() const;
+};
+
+class DeltaExport : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// @brief ctr
+    /// @param [in] _scene GraphScene* - the scene exported
+    /// @param [in] _changes ChangeStream* - the changes made to the scene, from before any node was added
+    DeltaExport(GraphScene *_scene, ChangeStream *_changes);
+
+    /// @brief Get the changes since a revision
+    /// @param [in] _sinceRevision quint64 - the revision the consumer holds, 0 if it holds nothing
+    /// @param [out] _delta ExportDelta* - the changes, a full resync if the revision is not the current one
+    /// @returns bool - false if there is no end node or a token is repeated as GraphScene::collectInformation
+    /// refuses it, the revision is not moved on. An incomplete node upstream of the end node leaves out everything
+    /// upstream, as GraphScene::collectInformation does, so only the member records are exported
+    bool collect(quint64 _sinceRevision, ExportDelta *_delta);
+    /// @brief Get the current revision
+    /// @returns quint64 - 0 before the first collect
+    quint64 revision() const {return m_revision;}
+
+private slots:
+    /// @brief Note what a batch of changes touched, nothing is recorded until the next collect
+    /// @param [in] _changes std::vector<GraphChange> - the changes
+    void apply(const std::vector<GraphChange> &_changes);
+
+private:
+    /// @brief The scene exported
+    GraphScene *m_scene;
+    /// @brief The changes made to the scene
+    ChangeStream *m_changes;
+    /// @brief Id of the end node, 0 if there is none
+    quint32 m_end;
+    /// @brief Ids of the member nodes in the order the scene holds them
+    std::vector<quint32> m_members;
+    /// @brief Ids of the nodes upstream of the end node at the last export, in the order they are exported
+    std::vector<quint32> m_upstreamOrder;
+    /// @brief The same ids for lookup
+    QSet<quint32> m_upstream;
+    /// @brief Ids of the exported nodes in export order at the last export
+    std::vector<quint32> m_order;
+    /// @brief Records of the last export by node id
+    QHash<quint32, std::string> m_records;
+    /// @brief Position of each record at the last export by node id
+    QHash<quint32, int> m_positions;
+    /// @brief Edges into the nodes upstream of the end node and the end node at the last walk, in walk order
+    std::vector<JournalEdge> m_edges;
+    /// @brief If everything upstream of the end node was complete and so exported at the last export
+    bool m_valid;
+    /// @brief How many member records led the last export
+    int m_memberCount;
+    /// @brief How many times each token GenUtils::tokensUnique compares appears in the last export, but for the
+    /// value type of the first node upstream of the end node
+    QHash<QByteArray, int> m_tokenCounts;
+    /// @brief How many tokens in m_tokenCounts appear more than once
+    int m_repeated;
+    /// @brief Revision of the last export
+    quint64 m_revision;
+    /// @brief Nodes renamed since the last export
+    QSet<quint32> m_touched;
+    /// @brief If member nodes were added or removed since the last export
+    bool m_membersChanged;
+    /// @brief If the nodes or edges upstream of the end node may have changed since the last export
+    bool m_upstreamChanged;
+
+    /// @brief Returns if a node may be exported
+    /// @param [in] _node GraphNode* - the node
+    /// @returns bool
+    static bool complete(GraphNode *_node);
+    /// @brief Count the tokens of a record in or out
+    /// @param [in,out] _counts QHash<QByteArray,int>* - how many times each token appears
+    /// @param [in,out] _repeated int* - how many tokens appear more than once
+    /// @param [in] _record std::string - the record
+    /// @param [in] _member bool - if the record is of a member node, counted as one token
+    /// @param [in] _step int - 1 to count the record in, -1 to count it out
+    static void countTokens(QHash<QByteArray, int> *_counts, int *_repeated, const std::string &_record,
+                            bool _member, int _step);
+    /// @brief Walk the graph upstream of the end node
+    /// @param [in] _end GraphNode* - the end node
+    /// @param [out] _order std::vector<quint32>* - ids of the nodes upstream of it, each after all that feed it
+    /// @param [out] _edges std::vector<JournalEdge>* - every edge into those nodes and the end node
+    static void walk(GraphNode *_end, std::vector<quint32> *_order, std::vector<JournalEdge> *_edges);
+    /// @brief Returns if a change to an edge can change what is exported
+    /// @param [in] _edge JournalEdge - the edge
+    /// @returns bool
+    bool exportsInto(const JournalEdge &_edge) const {return _edge.m_destinationNode == m_end ||
+                                                             m_upstream.contains(_edge.m_destinationNode);}
+};
+
+#endif /* __DELTAEXPORT_H__ */
@@ -19,6 +19,7 @@
 #define __CONNECTINGEDGE_H__
 
 #include <QGraphicsItem>
+#include <QLineF>
 #include "GraphNode.h"
 
 /// @file GraphEdge.h
@@ -35,6 +36,9 @@
 class GraphEdge : public QGraphicsItem
 {
 public:
+    /// @brief Item type used to identify edges with qgraphicsitem_cast
+    enum { Type = UserType + 3 };
+
     /// @brief Default ctr
     GraphEdge();
     /// @brief alternative ctr
@@ -44,6 +48,9 @@ public:
 
     /// @brief default dtr
     ~GraphEdge();
+    /// @brief Get the item type of the edge
+    /// @returns int
+    int type() const {return Type;}
 
     /// @brief Init function to initialise this edge
     void init();
@@ -77,11 +84,21 @@ public:
     /// @brief Get the arrow size
     /// @returns float
     float arrowSize() {return m_arrowSize;}
+    /// @brief Get the line between the source and destination sockets in scene coordinates
+    /// @returns QLineF
+    QLineF line() const {return QLineF(m_sourcePoint,m_destinationPoint);}
+    /// @brief Returns if the line, including its arrows, passes through a rectangle
+    /// @param [in] _rect QRectF - the rectangle to test in scene coordinates
+    /// @returns bool
+    bool intersectsRect(const QRectF &_rect) const;
 
 protected:
     /// @brief Function to get the bounding rectangle of the object
     /// @returns QRectF
     QRectF boundingRect() const;
+    /// @brief Get the exact shape of the edge so hit tests ignore the empty corners of the bounding rectangle
+    /// @returns QPainterPath
+    QPainterPath shape() const;
     /// @brief Paint function that is overridden from the virtual
     /// @param [in] painter QPainter* - the painter object to use
     /// @param [in] option QStyleOptionGraphicsItem* - options for the drawing style
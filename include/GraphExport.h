@@ -0,0 +1,57 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __GRAPHEXPORT_H__
+#define __GRAPHEXPORT_H__
+
+#include "Subgraph.h"
+
+#include <string>
+
+/// @file GraphExport.h
+/// @brief Exporting a saved graph without a scene
+/// @author Callum James
+/// @version 1.0
+/// @date 19/10/2026
+/// Revision History:
+/// Initial Version 19/10/2026
+/// @namespace GraphExport
+/// @brief Validates the plain records of a saved graph and builds the same #_#; string as
+/// GraphScene::collectInformation, so graphs can be checked and exported without creating any widgets.
+
+namespace GraphExport
+{
+    /// @brief Validate a saved graph and build its export
+    /// @param [in] _graph Subgraph - the graph, including its end node
+    /// @param [out] _string std::string* - the string to write the export to
+    /// @param [out] _error std::string* - the string to write the reason to if the graph is not valid
+    /// @returns bool - false if there is not exactly one end node, an edge breaks the connection rules, the graph
+    /// has a cycle, a node upstream of the end node is missing its type or a name, or a token is repeated
+    bool exportGraph(const Subgraph &_graph, std::string *_string, std::string *_error);
+    /// @brief Validate the records of a graph and build its export, edges must only refer to nodes in the records
+    /// @param [in] _nodes std::vector<SubgraphNode> - the nodes, including the end node
+    /// @param [in] _edges std::vector<SubgraphEdge> - the edges, in the order the scene created them
+    /// @param [out] _string std::string* - the string to write the export to
+    /// @param [out] _error std::string* - the string to write the reason to if the graph is not valid
+    /// @param [in] _strict bool - if false an incomplete node upstream of the end node leaves everything upstream out
+    /// of the export instead of failing it, as GraphScene::collectInformation does
+    /// @returns bool - as exportGraph
+    bool exportRecords(const std::vector<SubgraphNode> &_nodes, const std::vector<SubgraphEdge> &_edges,
+                       std::string *_string, std::string *_error, bool _strict = true);
+}
+
+#endif /* __GRAPHEXPORT_H__ */
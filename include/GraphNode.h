@@ -109,6 +109,9 @@ enum NODE_TYPE
 class GraphNode : public QGraphicsItem
 {
 public:
+    /// @brief Item type used to identify nodes with qgraphicsitem_cast
+    enum { Type = UserType + 1 };
+
     /// @brief Ctr for the GraphNode
     /// @param [in] _vType VALUE_TYPE - the top level type of the node
     /// @param [in] _type NODE_TYPE - the bottom level type of the node
@@ -129,6 +132,9 @@ public:
     GraphNode(qreal _x, qreal _y, VALUE_TYPE _vType=VT_NOTYPE, NODE_TYPE _type=NT_NOTYPE, QGraphicsItem *_parent=0);
     /// @brief dtr
     ~GraphNode();
+    /// @brief Get the item type of the node
+    /// @returns int
+    int type() const {return Type;}
     /// @brief Set the node as selected
     /// @param [in] _selected bool - whether to set it as selected or not
     void setSelectedNode(bool _selected) {prepareGeometryChange(); m_selected = _selected;}
@@ -212,9 +218,26 @@ public:
     /// @brief Set the clearence of the socket
     /// @param [in] _clearence SOCKET_CLEARENCE - whether the node can accept in, out or both types
     void setSocketClearence(SOCKET_CLEARENCE _clearence) {m_socketClearence = _clearence;}
-    /// @brief Get the z depth of the node in the scene - currently not affecting results
+    /// @brief Get the z depth of the node in the scene, nodes with a higher depth are drawn and picked above lower ones
     /// @returns int
     int zDepth() {return m_zDepth;}
+    /// @brief Get the id of the node, unique within its scene and kept for the life of the node
+    /// @returns quint32
+    quint32 id() {return m_id;}
+    /// @brief Set the id of the node, only the scene should do this
+    /// @param [in] _id quint32 - the new id
+    void setId(quint32 _id) {m_id = _id;}
+    /// @brief Find the index of one of this nodes inbound sockets
+    /// @param [in] _socket NodeSocket* - the socket to look for
+    /// @returns int - the index, or -1 if the socket is not on this node
+    int inboundSocketIndex(NodeSocket *_socket);
+    /// @brief Find the index of one of this nodes outbound sockets
+    /// @param [in] _socket NodeSocket* - the socket to look for
+    /// @returns int - the index, or -1 if the socket is not on this node
+    int outboundSocketIndex(NodeSocket *_socket);
+    /// @brief Set the z depth of the node, this also sets the z value of the node and its sockets
+    /// @param [in] _depth int - the new depth, maintained by the scene
+    void setZDepth(int _depth);
     /// @brief Get width of node
     /// @returns qreal
     qreal getWidth() {return m_width;}
@@ -256,6 +279,14 @@ public:
     /// @brief Get number of inbound sockets on the node
     /// @returns int
     int numInboundSockets() {return m_numInboundSockets;}
+    /// @brief Get an outbound socket on the node
+    /// @param [in] _index int - index of the socket
+    /// @returns NodeSocket*
+    NodeSocket *outboundSocket(int _index) {return m_outboundSockets->at(_index);}
+    /// @brief Get an inbound socket on the node
+    /// @param [in] _index int - index of the socket
+    /// @returns NodeSocket*
+    NodeSocket *inboundSocket(int _index) {return m_inboundSockets->at(_index);}
 
     /// @brief Returns whether the node is deletable or not
     /// @returns bool
@@ -272,10 +303,6 @@ public:
     /// @brief Get the node information as a string
     /// @returns std::string
     std::string getNodeInfo();
-    /// @brief get the all inbound socket information - store to passed in vec
-    /// @param [in] _vec std::vector<std::string>* - vector to write result to
-    /// @returns bool
-    bool gatherInboundSocketInfo(std::vector<std::string> *_vec);
     /// @brief Get the centre of the node
     /// @returns QPointF
     QPointF centre();
@@ -291,6 +318,10 @@ public:
     /// @brief get the base height
     /// @returns qreal
     qreal getBaseHeight() {return m_baseHeight;}
+    /// @brief Borrow the text labels from the parent scene and show them
+    void showLabels();
+    /// @brief Give the text labels back to the parent scene
+    void hideLabels();
 
 private:
     /// @brief Clearence of the node
@@ -313,6 +344,8 @@ private:
     int m_highlightEdgeThickness;
     /// @brief If the ndoe is selected or not
     bool m_selected;
+    /// @brief The title shown in the type label
+    std::string m_title;
     /// @brief Item to hold the node type name
     QGraphicsTextItem *m_nodeTypeText;
     /// @brief Item to hold the node name
@@ -334,10 +367,11 @@ private:
     QPointF m_nodePoint;
     /// @brief Offset of the ndoe poiint to the mouse cursor
     QPointF m_offsetToCursor;// used to determine the offset to where the user has clicked
+    /// @brief Stable id of the node within its scene
+    quint32 m_id;
     /// @brief Z depth of the node in the scene
-    int m_zDepth; // used when two ndoes overlap each other, this value will be assigned
-    // when it is not equal to -1, it means there are some nodes overlapping and each node will have its own value
-    // when this occurs, when selecting the node, the node at that point with the highest zDepth will be selected
+    int m_zDepth; // position of the node in the scenes stacking order, -1 until the scene assigns one
+    // every node in a scene has its own value and the node at a point with the highest zDepth is the one selected
     /// @brief Wether the node is being moved or not
     bool m_move;
     /// @brief If the node is deletable or not
@@ -354,6 +388,8 @@ private:
     void addInboundSocket();
     /// @brief Function to add an outbound socket
     void addOutboundSocket();
+    /// @brief Function to position the text labels relative to the node point
+    void positionLabels();
     /// @brief Function to calculate all socket positions
     void calculateSocketPositions();
     /// @brief Function to calculate inbound socket positions
@@ -0,0 +1,158 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __GRAPHPROGRAM_H__
+#define __GRAPHPROGRAM_H__
+
+#include "GraphNode.h"
+#include "TaskScheduler.h"
+
+#include <QHash>
+
+#include <string>
+#include <vector>
+
+/// @file GraphProgram.h
+/// @brief The graph upstream of the end node lowered into a flat program
+/// @author Callum James
+/// @version 1.0
+/// @date 19/10/2026
+/// Revision History:
+/// Initial Version 19/10/2026
+/// @class GraphProgram
+/// @brief Compiling walks the scene once and gives every node upstream of the end node a register slot in
+/// topological order, with one instruction per slot naming the slots it reads. Running the program only touches
+/// these arrays and each node's own names, never the sockets and edges, so repeated evaluations avoid the pointer
+/// chasing of a walk. Renamed nodes mark their slot and the slots that read it dirty through the compiled dependent
+/// lists, and a run only executes the dirty slots. An edge added or removed into a node with a slot marks it the
+/// same way and leaves the program stale, lowering it again for the same node keeps the result of every slot that
+/// is still clean so only the changed cone is executed.
+
+/// @struct NodeResult
+/// @brief The evaluated result of a node
+struct NodeResult
+{
+    /// @brief The node's export tokens, for the end node the tokens of every node upstream of it
+    std::vector<std::string> m_tokens;
+    /// @brief If the node and everything upstream of it have a type and both names set
+    bool m_valid;
+};
+
+/// @enum PROGRAM_OP
+/// @brief What an instruction computes
+enum PROGRAM_OP
+{
+    OP_RECORD = 0,
+    OP_GATHER
+};
+
+/// @struct ProgramInstruction
+/// @brief Computes the register slot with the same index as the instruction
+struct ProgramInstruction
+{
+    /// @brief The operation
+    quint8 m_op;
+    /// @brief Index of the first slot read in the operand list
+    quint32 m_firstOperand;
+    /// @brief Number of slots read
+    quint32 m_numOperands;
+};
+
+class SlotTask;
+
+class GraphProgram
+{
+    friend class SlotTask;
+
+public:
+    /// @brief ctr
+    GraphProgram();
+
+    /// @brief Lower everything upstream of a node into a program, if it was compiled for the same node before the
+    /// slots that were clean keep their results and every other slot starts dirty
+    /// @param [in] _end GraphNode* - the node to compile for, normally the end node
+    void compile(GraphNode *_end);
+    /// @brief Throw the program and every result away
+    void invalidate();
+    /// @brief Mark the slot of a node and every slot reading it dirty and leave the program to be lowered again,
+    /// used when an edge into the node is added or removed
+    /// @param [in] _node GraphNode* - the destination of the edge, it must have a slot
+    void reshape(GraphNode *_node);
+    /// @brief Mark every slot reading a node dirty and drop its slot, used when the node leaves the scene
+    /// @param [in] _node GraphNode* - the removed node, it must have a slot
+    void remove(GraphNode *_node);
+    /// @brief Returns if there is a compiled program
+    /// @returns bool
+    bool compiled() const {return m_compiled;}
+    /// @brief Returns if the program has to be lowered again before it is run
+    /// @returns bool
+    bool stale() const {return m_stale;}
+    /// @brief Get the node the program was compiled for
+    /// @returns GraphNode*
+    GraphNode *root() const {return m_compiled ? m_nodes.back() : NULL;}
+    /// @brief Returns if a node has a slot in the program
+    /// @param [in] _node GraphNode* - the node
+    /// @returns bool
+    bool contains(GraphNode *_node) const {return m_slots.contains(_node);}
+    /// @brief Get the number of slots
+    /// @returns int
+    int size() const {return int(m_nodes.size());}
+
+    /// @brief Mark the slot of a node and every slot reading it dirty, used when its name changes
+    /// @param [in] _node GraphNode* - the changed node
+    void markDirty(GraphNode *_node);
+    /// @brief Execute every dirty slot
+    /// @param [in] _scheduler TaskScheduler* - runs large batches of independent slots in parallel, may be NULL
+    /// @returns int - the number of slots executed
+    int run(TaskScheduler *_scheduler);
+    /// @brief Get the result of the node the program was compiled for
+    /// @returns NodeResult
+    const NodeResult &result() const {return m_results.back();}
+
+    /// @brief Build the export record of a single node
+    /// @param [in] _node GraphNode* - the node
+    /// @param [out] _result NodeResult* - the tokens are replaced and m_valid cleared if the node is incomplete
+    static void nodeRecord(GraphNode *_node, NodeResult *_result);
+
+private:
+    /// @brief Node of each slot, the root last
+    std::vector<GraphNode*> m_nodes;
+    /// @brief Instruction of each slot
+    std::vector<ProgramInstruction> m_instructions;
+    /// @brief Slots read by the instructions
+    std::vector<quint32> m_operands;
+    /// @brief Start of each slots list in m_dependents, one extra entry marks the end
+    std::vector<quint32> m_firstDependent;
+    /// @brief Slots reading each slot
+    std::vector<quint32> m_dependents;
+    /// @brief Register of each slot
+    std::vector<NodeResult> m_results;
+    /// @brief If each slot needs executing
+    std::vector<quint8> m_dirty;
+    /// @brief Slot of each node
+    QHash<GraphNode*, quint32> m_slots;
+    /// @brief If the arrays hold a program
+    bool m_compiled;
+    /// @brief If an edge into the program changed since it was compiled
+    bool m_stale;
+
+    /// @brief Execute one slot whose operands are all clean, safe to call from several threads for different slots
+    /// @param [in] _slot quint32 - the slot
+    void execute(quint32 _slot);
+};
+
+#endif /* __GRAPHPROGRAM_H__ */
@@ -21,11 +21,27 @@
 #include "GraphNode.h"
 #include "GraphEdge.h"
 #include "NodeEdit.h"
+#include "StaticLayerCache.h"
+#include "SpatialHash.h"
+#include "CacheBudget.h"
+#include "Subgraph.h"
+#include "UndoJournal.h"
+#include "TopologicalOrder.h"
+#include "DataflowEngine.h"
+#include "GraphSnapshot.h"
+#include "ChangeStream.h"
+#include "DeltaExport.h"
 
 #include <QWidget>
 #include <QGraphicsView>
 #include <QGraphicsScene>
 #include <QGraphicsItem>
+#include <QGraphicsTextItem>
+#include <QSet>
+#include <QRubberBand>
+#include <QFuture>
+
+#include <map>
 
 #include <QLayout>
 
@@ -59,14 +75,22 @@
  * Once added, an end node will need to be added. This is the target node for all other nodes. When using the graph within the application:
  *  - Zoom in and out with the mouse wheel
  *  - Right click and drag a node to move it around
+ *  - Left click and drag over empty space to select all nodes in an area, hold shift to add to the current selection
+ *  - Right click and drag a selected node to move the whole selection
+ *  - Ctrl+C, Ctrl+X and Ctrl+V copy, cut and paste the selection, Ctrl+D duplicates it
+ *  - Ctrl+Z undoes the last change, Ctrl+Shift+Z or Ctrl+Y redoes it
  *  - Left click a red outbound socket and drag to a green inbound socket to join the nodes
  *  - Press space and select the node you want to add a new node
  *  - Select a node with left click and press space or delete to remove a node and all connections to that node
  *  - double click a node to enter node edit mode to change its name and short name. Press enter to save the edit
  *
  * @section limitations_sec Current Limitations
- * The nodegraph, in its current iteration, lacks some functionality that needs to be added. Currently for example
- * chained nodes have no effect. The nodegraph is still being developed to rectify such limitations.
+ * The nodegraph, in its current iteration, lacks some functionality that needs to be added. Chained nodes are now
+ * exported, every node upstream of the end node is gathered once and after the nodes feeding it, but the export
+ * carries names and types only and values are computed by BatchEvaluator alone. Only the nodes and edges near the
+ * view are kept in the Qt scene, but every node, socket and edge item stays allocated as it is also the graph model,
+ * so memory still grows with the size of the whole graph. The nodegraph is still being developed to rectify such
+ * limitations.
  **/
 
 class GraphScene : public QGraphicsView
@@ -87,6 +111,37 @@ public:
     /// @param [in] _string std::string* - the string to write the result to
     /// @returns bool
     bool collectInformation(std::string *_string); // this function will only work if an end node exists
+    /// @brief Save every node and edge, including the end node, so the graph can be exported without the view
+    /// @param [in] _fileName QString - the file to write
+    /// @returns bool - false if the file could not be written
+    bool saveGraph(const QString &_fileName);
+    /// @brief Export the graph on a worker thread, the scene can be edited while it runs
+    /// The graph is exported as it was when this was called, informationCollected is emitted with the result.
+    /// The string is the one collectInformation would have returned, a refused graph comes with a reason.
+    /// @returns QFuture<ExportResult> - the result, for callers that would rather wait on it
+    QFuture<ExportResult> collectInformationAsync();
+    /// @brief Export only the node records changed since an earlier export
+    /// @param [in] _sinceRevision quint64 - the revision of the consumers last export, 0 if it has none
+    /// @param [out] _delta ExportDelta* - the changes and the new revision, everything if the revision is out of date
+    /// @returns bool - false if there is no end node or a token is repeated, the graph collectInformation refuses
+    bool collectDelta(quint64 _sinceRevision, ExportDelta *_delta) {return m_delta->collect(_sinceRevision,_delta);}
+    /// @brief Export the graph in the binary format of BinaryExport.h, the exported nodes followed by the end node
+    /// and every edge between them, read it with BinaryExportReader.h
+    /// @param [out] _data QByteArray* - the buffer to write to
+    /// @returns bool - false if there is no end node or a token is repeated, the graph collectInformation refuses. An
+    /// incomplete node upstream of the end node leaves out everything upstream, as collectInformation does
+    bool collectBinary(QByteArray *_data);
+    /// @brief Recreate the nodes of a string returned by collectInformation, joined to the end node, as one step
+    /// The string only lists the nodes, so nodes that were chained come back joined straight to the end node.
+    /// @param [in] _export std::string_view - the #_#; string
+    /// @returns bool - false if there is no end node, the string can not be read or a node is not joined to the end
+    /// node, nothing is created unless the end node's port refuses a join the connection rules allow
+    bool restoreInformation(std::string_view _export);
+    /// @brief Get every node collectInformation exports, member nodes then everything upstream of the end node
+    /// @param [out] _nodes std::vector<GraphNode*>* - the vector to write the nodes to
+    /// @param [out] _end GraphNode** - if not NULL set to the end node
+    /// @returns bool - false if there is no end node
+    bool exportedNodes(std::vector<GraphNode*> *_nodes, GraphNode **_end = NULL);
 
     // this is simply a test debug function to print out information on each node
     /// @brief Print all node information in the scene
@@ -156,10 +211,118 @@ public:
     /// @brief Remove an item from the scene
     /// @param [in] _item QGraphicsItem* - the item to remove
     void removeFromScene(QGraphicsItem *_item);
+    /// @brief Tell the scene a node has moved or changed size so it can be re-indexed
+    /// @param [in] _node GraphNode* - the node that changed
+    void nodeGeometryChanged(GraphNode *_node);
+    /// @brief Tell the scene an edge has moved so it can be re-indexed
+    /// @param [in] _edge GraphEdge* - the edge that changed
+    void edgeGeometryChanged(GraphEdge *_edge);
+    /// @brief Take a text label from the reuse pool, creating one if the pool is empty
+    /// @returns QGraphicsTextItem*
+    QGraphicsTextItem *takeLabel();
+    /// @brief Give a text label back to the reuse pool
+    /// @param [in] _label QGraphicsTextItem* - the label no longer needed by a node
+    void returnLabel(QGraphicsTextItem *_label);
+    /// @brief Create every node and edge of a subgraph in one batch, the new nodes become the selection
+    /// @param [in] _subgraph Subgraph - the nodes and edges to create
+    /// @param [in] _origin QPointF - scene position for the top left of the subgraph
+    /// @param [in] _sink GraphNode* - if not NULL every created node with an outbound socket is also joined to its
+    /// first inbound socket, in the same step
+    /// @param [out] _refused int* - if not NULL set to the number of edges and joins to the sink that were refused
+    /// @returns std::vector<GraphNode*> - the created nodes in subgraph order
+    std::vector<GraphNode*> insertSubgraph(const Subgraph &_subgraph, QPointF _origin, GraphNode *_sink = NULL,
+                                           int *_refused = NULL);
+    /// @brief Get every selected node
+    /// @returns std::vector<GraphNode*>
+    std::vector<GraphNode*> selectedNodes();
+    /// @brief Returns if an edge may be created between two sockets, duplicate edges, edges between incompatible node
+    /// types, edges to the same node and edges closing a cycle are refused
+    /// @param [in] _source NodeSocket* - the outbound socket the edge leaves
+    /// @param [in] _destination NodeSocket* - the inbound socket the edge enters
+    /// @returns bool
+    bool canConnectSockets(NodeSocket *_source, NodeSocket *_destination);
+    /// @brief Create an edge between two sockets if it is allowed, keeping the topological order up to date
+    /// @param [in] _source NodeSocket* - the outbound socket the edge leaves
+    /// @param [in] _destination NodeSocket* - the inbound socket the edge enters
+    /// @returns GraphEdge* - the new edge, NULL if it was refused
+    GraphEdge *connectSockets(NodeSocket *_source, NodeSocket *_destination);
+    /// @brief Get every node ordered so that each edge leads from an earlier node to a later one
+    /// @returns std::vector<GraphNode*>
+    std::vector<GraphNode*> topologicalOrder() const {return m_topology.order();}
+    /// @brief Get the engine holding the result of each node, its counters report how much each export recomputed
+    /// @returns DataflowEngine*
+    DataflowEngine *dataflow() {return &m_dataflow;}
+    /// @brief Find a node by its id
+    /// @param [in] _id quint32 - the id of the node
+    /// @returns GraphNode* - NULL if no node has the id
+    GraphNode *nodeById(quint32 _id);
+    /// @brief Tell the scene a node has been renamed so the change can be journaled
+    /// @param [in] _node GraphNode* - the renamed node, already holding its new names
+    /// @param [in] _oldName std::string - the name before the change
+    /// @param [in] _oldShortName std::string - the short name before the change
+    void nodeRenamed(GraphNode *_node, const std::string &_oldName, const std::string &_oldShortName);
+    /// @brief Recreate a node from the journal with its original id
+    /// @param [in] _node JournalNode - the node to recreate
+    /// @returns GraphNode*
+    GraphNode *restoreNode(const JournalNode &_node);
+    /// @brief Remove a set of nodes by id
+    /// @param [in] _ids std::vector<quint32> - ids of the nodes to remove
+    /// @returns int - the number of nodes removed
+    int removeNodesById(const std::vector<quint32> &_ids);
+    /// @brief Create an edge between two nodes given by id
+    /// @param [in] _edge JournalEdge - the edge to create
+    /// @returns bool
+    bool connectById(const JournalEdge &_edge);
+    /// @brief Remove an edge between two nodes given by id
+    /// @param [in] _edge JournalEdge - the edge to remove
+    /// @returns bool
+    bool disconnectById(const JournalEdge &_edge);
+    /// @brief Move a node given by id
+    /// @param [in] _id quint32 - id of the node
+    /// @param [in] _point QPointF - the new position
+    void moveNodeById(quint32 _id, QPointF _point);
+    /// @brief Rename a node given by id
+    /// @param [in] _id quint32 - id of the node
+    /// @param [in] _name std::string - the new name
+    /// @param [in] _shortName std::string - the new short name
+    void renameNodeById(quint32 _id, const std::string &_name, const std::string &_shortName);
+    /// @brief Set the maximum memory the undo history may use
+    /// @param [in] _bytes qint64 - the budget in bytes
+    void setUndoBudget(qint64 _bytes);
+    /// @brief Start a batch of scene changes, repaints are held back until the matching endBatch
+    void beginBatch();
+    /// @brief End a batch of scene changes and repaint once if it was the outermost batch
+    void endBatch();
+    /// @brief Set how many bytes the node pixmap caches may use in total
+    /// @param [in] _bytes qint64 - the budget in bytes
+    void setCacheBudget(qint64 _bytes);
+    /// @brief Get how many bytes the node pixmap caches may use in total
+    /// @returns qint64
+    qint64 cacheBudget() const;
+    /// @brief Get the estimated number of bytes the node pixmap caches currently use
+    /// @returns qint64
+    qint64 cacheUsage() const;
+
+protected:
+    /// @brief Draw the background of the scene, including the static layer cache while dragging
+    /// @param [in] painter QPainter* - the painter to draw with
+    /// @param [in] rect QRectF - the exposed area in scene coordinates
+    void drawBackground(QPainter *painter, const QRectF &rect);
+    /// @brief Scroll the view and stream items in or out around the new viewport
+    /// @param [in] dx int - horizontal scroll
+    /// @param [in] dy int - vertical scroll
+    void scrollContentsBy(int dx, int dy);
 
 signals:
     /// @brief Show the node selection menu
     void nodeMenuRequested(const QPoint&);
+    /// @brief An export started by collectInformationAsync has finished
+    /// @param [in] _ok bool - if the graph was valid
+    /// @param [in] _result QString - the #_#; string if valid, otherwise the reason it is not
+    void informationCollected(bool _ok, const QString &_result);
+    /// @brief The graph has changed, sent at most once per event loop turn with every change since the last
+    /// @param [in] _changes std::vector<GraphChange> - the changes in the order they happened, by node id
+    void graphChanged(const std::vector<GraphChange> &_changes);
 
 public slots:
     // I am making the zoom  and translate functions public slots in case it needs to be updated from somewhere
@@ -172,7 +335,19 @@ public slots:
     /// @brief Translate across the scene - currently not working due to bug in Qt library
     /// @param [in] _x qreal - move by this in the x
     /// @param [in] _y qreal - move by this in the y
-    void navScene(qreal _x, qreal _y) {translate(_x,_y);}
+    void navScene(qreal _x, qreal _y);
+    /// @brief Copy the selected nodes and the edges between them to the clipboard
+    void copySelection();
+    /// @brief Copy the selected nodes to the clipboard then remove them
+    void cutSelection();
+    /// @brief Paste nodes from the clipboard under the mouse cursor
+    void pasteClipboard();
+    /// @brief Copy the selected nodes and the edges between them in place
+    void duplicateSelection();
+    /// @brief Undo the last step
+    void undo();
+    /// @brief Redo the last undone step
+    void redo();
 
 private slots:
     /// @brief Create an object node
@@ -205,6 +380,32 @@ private:
     QGraphicsScene *m_scene;
     /// @brief The editing UI used to edit nodes
     NodeEdit *m_nodeEdit;
+    /// @brief Tiled cache of the scene that is not moving while a node is dragged
+    StaticLayerCache *m_staticLayer;
+    /// @brief Chooses the cache mode of each node and keeps their pixmaps within budget
+    CacheBudget *m_cacheBudget;
+    /// @brief Batches the changes sent out through graphChanged
+    ChangeStream *m_changes;
+
+    // every node and edge is kept in these indices, but only those near the viewport are added to m_scene
+    // the items themselves stay allocated as they are also the graph model, what is saved for off screen items is
+    // their place in the QGraphicsScene index, their labels and their cached pixmaps
+    /// @brief Spatial index of every node in the graph
+    SpatialHash<GraphNode*> m_nodeIndex;
+    /// @brief Spatial index of every edge in the graph
+    SpatialHash<GraphEdge*> m_edgeIndex;
+    /// @brief Nodes currently added to m_scene
+    QSet<GraphNode*> m_materializedNodes;
+    /// @brief Edges currently added to m_scene
+    QSet<GraphEdge*> m_materializedEdges;
+    /// @brief Scene area around the viewport whose items are added to m_scene
+    QRectF m_materializedRegion;
+    /// @brief Text labels not currently used by any node
+    std::vector<QGraphicsTextItem*> m_labelPool;
+    /// @brief Every node keyed by its z depth, the last node is the one on top
+    std::map<int, GraphNode*> m_zOrder;
+    /// @brief The depth the next raised node will be given
+    int m_nextZDepth;
 
     /// @brief Vector of all nodes in the scene
     std::vector<GraphNode*> *m_nodesInScene;
@@ -227,6 +428,38 @@ private:
     bool m_nodeActive; // boolean flag for if a node is active or not
     /// @brief If a node has been selected
     bool m_nodeSelected;
+    /// @brief Every selected node
+    QSet<GraphNode*> m_selection;
+    /// @brief Nodes moved together by the current drag
+    std::vector<GraphNode*> m_dragGroup;
+    /// @brief Each edge connected to the drag group, listed once
+    std::vector<GraphEdge*> m_dragEdges;
+    /// @brief Position of each node in the drag group when the drag started
+    std::vector<QPointF> m_dragStart;
+    /// @brief Undo and redo history
+    UndoJournal *m_journal;
+    /// @brief Records of the last delta export
+    DeltaExport *m_delta;
+    /// @brief Every node keyed by its id
+    QHash<quint32, GraphNode*> m_nodeIds;
+    /// @brief Id the next created node will be given
+    quint32 m_nextNodeId;
+    /// @brief Order of the nodes along their edges, used to refuse edges that would close a cycle
+    TopologicalOrder m_topology;
+    /// @brief Result of each node, recomputed only where the graph has changed
+    DataflowEngine m_dataflow;
+    /// @brief Plain records of the graph that snapshots for asynchronous exports are taken from
+    GraphMirror m_mirror;
+    /// @brief Worker threads shared by anything evaluating the graph in parallel
+    TaskScheduler *m_scheduler;
+    /// @brief Depth of nested scene change batches
+    int m_batchDepth;
+    /// @brief If the user is dragging out a selection area
+    bool m_selectingArea;
+    /// @brief Viewport point the selection area was started at
+    QPoint m_rubberBandOrigin;
+    /// @brief Rectangle shown while dragging out a selection area
+    QRubberBand *m_rubberBand;
 
     /// @brief The menu used for creating a new node
     QMenu *m_nodeSelectMenu;
@@ -254,8 +487,30 @@ private:
     /// @param [in] _nodeToRemove GraphNode* - the node to remove
     /// @returns bool
     bool removeNode(GraphNode *_nodeToRemove);
+    /// @brief Create a node and register it with the scene without repainting
+    /// @param [in] _valueTy VALUE_TYPE - top level type of the node
+    /// @param [in] _type NODE_TYPE - bottom level type of the node
+    /// @param [in] _point QPointF - the point to add the node at
+    /// @param [in] _parent GraphScene* - the parent scene for the node
+    /// @param [in] _inboundSK int - number of inbound sockets on the node
+    /// @param [in] _outboundSK int - number of outbound sockets on the node
+    /// @param [in] _editable bool - whether the node is editable or not
+    /// @param [in] _deletable bool - whether the node is deletable or not
+    /// @param [in] _id quint32 - the id to give the node, 0 for the next free one
+    /// @returns GraphNode*
+    GraphNode *createNode(VALUE_TYPE _valueTy, NODE_TYPE _type, QPointF _point, GraphScene *_parent, int _inboundSK, int _outboundSK, bool _editable, bool _deletable, quint32 _id = 0);
+    /// @brief Remove a set of nodes in one go, undeletable nodes are skipped
+    /// @param [in] _nodes std::vector<GraphNode*> - the nodes to remove
+    /// @returns int - the number of nodes removed
+    int removeNodes(const std::vector<GraphNode*> &_nodes);
     /// @brief Remove all nodes
     void removeAllNodes();
+    /// @brief Make a journal record of an edge
+    /// @param [in] _edge GraphEdge* - the edge to record
+    /// @returns JournalEdge
+    JournalEdge edgeRecord(GraphEdge *_edge);
+    /// @brief Repaint the viewport unless a batch is in progress
+    void scheduleRepaint();
     /// @brief Select the active node
     /// @param [in] _select bool - whether to select it or not
     void activeNodeSelected(bool _select);
@@ -266,6 +521,43 @@ private:
     bool findNodeIndex(GraphNode *_node, int *_index);
     /// @brief Populate the node selection menu
     void populateNodeSelectionMenu();
+    /// @brief Gather every top level item that moves with the drag group, the nodes, their sockets and connected edges
+    /// @param [out] _items std::vector<QGraphicsItem*>* - vector to write the items to
+    void collectMovingItems(std::vector<QGraphicsItem*> *_items);
+    /// @brief Build the static layer cache for the nodes currently being moved
+    void cacheStaticLayer();
+    /// @brief Called whenever the view is scrolled, zoomed or resized
+    void viewChanged();
+    /// @brief Recompute the region around the viewport and stream items in or out of m_scene
+    void updateMaterializedRegion();
+    /// @brief Add or remove a node from m_scene depending on whether it is in the materialized region
+    /// @param [in] _node GraphNode* - the node to check
+    void syncNode(GraphNode *_node);
+    /// @brief Add or remove an edge from m_scene depending on whether it is in the materialized region
+    /// @param [in] _edge GraphEdge* - the edge to check
+    void syncEdge(GraphEdge *_edge);
+    /// @brief Add a node, its labels and its sockets to m_scene
+    /// @param [in] _node GraphNode* - the node to add
+    void materializeNode(GraphNode *_node);
+    /// @brief Remove a node and its sockets from m_scene and return its labels to the pool
+    /// @param [in] _node GraphNode* - the node to remove
+    void dematerializeNode(GraphNode *_node);
+    /// @brief Deselect every selected node
+    void clearSelection();
+    /// @brief Add every node overlapping an area to the selection
+    /// @param [in] _rect QRectF - the area in scene coordinates
+    void selectNodesInRect(const QRectF &_rect);
+    /// @brief Set up the drag group for a node about to be moved, the whole selection if the node is part of it
+    /// @param [in] _node GraphNode* - the node grabbed by the user
+    void beginDrag(GraphNode *_node);
+    /// @brief Move every node in the drag group by the same amount and update their edges
+    /// @param [in] _delta QPointF - the translation to apply
+    void moveDragGroup(QPointF _delta);
+    /// @brief Put a node on top of every other node
+    /// @param [in] _node GraphNode* - the node to raise
+    void raiseNode(GraphNode *_node);
+    /// @brief Renumber the z depths from 0 keeping their order, used when the depths run out
+    void compactZOrder();
     /// @brief If an end zone is in the scene
     bool m_endNodeInScene; // can only have one end node
 
@@ -273,6 +565,10 @@ private slots:
     /// @brief Show node creation menu
     /// @param _pos QPoint - the point to create the menu at
     void showNodeMenu(const QPoint&_pos);
+    /// @brief Repaint once the static layer cache has finished rendering
+    void staticLayerReady();
+    /// @brief Pass on the result of an asynchronous export
+    void informationReady();
 };
 
 #endif /* __GRAPHSCENE_H__ */
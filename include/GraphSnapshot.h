@@ -0,0 +1,161 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __GRAPHSNAPSHOT_H__
+#define __GRAPHSNAPSHOT_H__
+
+#include "Subgraph.h"
+#include "GraphEdge.h"
+
+#include <QHash>
+#include <QVector>
+
+#include <string>
+#include <vector>
+
+/// @file GraphSnapshot.h
+/// @brief Immutable copies of the graph for exporting off the GUI thread
+/// @author Callum James
+/// @version 1.0
+/// @date 19/10/2026
+/// Revision History:
+/// Initial Version 19/10/2026
+/// @class GraphMirror
+/// @brief Keeps plain records of every node and edge in the scene up to date as they change, in fixed size chunks
+/// held in implicitly shared Qt containers. Taking a GraphSnapshot only copies the outer container handle, so it
+/// costs the same whatever the size of the graph. An edit made while a snapshot is alive copies the outer list of
+/// chunk handles and the one chunk it touches, the snapshot keeps seeing the graph as it was.
+/// @class GraphSnapshot
+/// @brief The records of the graph at one point in time. It is never changed once taken, so it can be read on any
+/// thread while the scene keeps being edited.
+
+/// @brief Number of node records in a chunk, a power of two
+#define SNAPSHOT_CHUNK_SHIFT 6
+#define SNAPSHOT_CHUNK_SIZE (1 << SNAPSHOT_CHUNK_SHIFT)
+
+/// @struct ExportResult
+/// @brief The outcome of exporting a snapshot
+struct ExportResult
+{
+    /// @brief If the graph is valid
+    bool m_ok;
+    /// @brief The #_#; string if valid
+    std::string m_string;
+    /// @brief Why the graph is not valid
+    std::string m_error;
+};
+
+/// @struct SnapshotInput
+/// @brief An edge entering a node
+struct SnapshotInput
+{
+    /// @brief Slot of the source node
+    int m_sourceSlot;
+    /// @brief Index of the outbound socket on the source node
+    int m_sourceSocket;
+    /// @brief Index of the inbound socket on this node
+    int m_destinationSocket;
+};
+
+/// @struct SnapshotNode
+/// @brief A node slot
+struct SnapshotNode
+{
+    /// @brief The node, only what the export reads is kept current
+    SubgraphNode m_record;
+    /// @brief Edges entering the node in the order they were created
+    std::vector<SnapshotInput> m_inputs;
+    /// @brief When the node was added, slots are reused so the export is ordered by this rather than the slot
+    quint64 m_sequence;
+    /// @brief If the slot holds a node
+    bool m_used;
+
+    SnapshotNode() : m_sequence(0), m_used(false) {}
+};
+
+class GraphSnapshot
+{
+    friend class GraphMirror;
+
+public:
+    /// @brief ctr, an empty graph
+    GraphSnapshot() : m_numNodes(0) {}
+
+    /// @brief Get the number of nodes
+    /// @returns int
+    int numNodes() const {return m_numNodes;}
+    /// @brief Build the export as GraphScene::collectInformation does, member nodes in the order they were added
+    /// and nothing upstream of the end node if any node there is incomplete, see GraphExport::exportRecords
+    /// @returns ExportResult
+    ExportResult exportGraph() const;
+
+private:
+    /// @brief Node slots, SNAPSHOT_CHUNK_SIZE to a chunk
+    QVector<QVector<SnapshotNode> > m_chunks;
+    /// @brief Number of used slots
+    int m_numNodes;
+};
+
+class GraphMirror
+{
+public:
+    /// @brief ctr
+    GraphMirror();
+
+    /// @brief Start mirroring a node
+    /// @param [in] _node GraphNode* - the new node
+    void addNode(GraphNode *_node);
+    /// @brief Stop mirroring a node and every edge it feeds
+    /// @param [in] _node GraphNode* - the removed node
+    void removeNode(GraphNode *_node);
+    /// @brief Re-record a node, used when its name changes
+    /// @param [in] _node GraphNode* - the changed node
+    void nodeChanged(GraphNode *_node);
+    /// @brief Mirror a new edge
+    /// @param [in] _edge GraphEdge* - the new edge
+    void addEdge(GraphEdge *_edge);
+    /// @brief Stop mirroring an edge
+    /// @param [in] _edge GraphEdge* - the removed edge
+    void removeEdge(GraphEdge *_edge);
+    /// @brief Take a snapshot of the graph, constant time
+    /// @returns GraphSnapshot
+    GraphSnapshot snapshot() const {return m_snapshot;}
+
+private:
+    /// @brief The current records, shared with every snapshot until the next edit
+    GraphSnapshot m_snapshot;
+    /// @brief Slot of each node, only used on the GUI thread so never shared
+    QHash<GraphNode*, int> m_slots;
+    /// @brief Slots freed by removed nodes
+    std::vector<int> m_freeSlots;
+    /// @brief Number of slots ever used
+    int m_numSlots;
+    /// @brief Sequence number given to the next node added
+    quint64 m_nextSequence;
+
+    /// @brief Get a slot for writing, copying its chunk if a snapshot still shares it
+    /// @param [in] _slot int - the slot
+    /// @returns SnapshotNode&
+    SnapshotNode &writeSlot(int _slot);
+    /// @brief Find the slots at the two ends of an edge
+    /// @param [in] _edge GraphEdge* - the edge
+    /// @param [out] _input SnapshotInput* - the input record of the edge
+    /// @returns int - slot of the destination node, -1 if either end is not mirrored
+    int edgeSlots(GraphEdge *_edge, SnapshotInput *_input) const;
+};
+
+#endif /* __GRAPHSNAPSHOT_H__ */
@@ -0,0 +1,65 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __LEGACYPARSER_H__
+#define __LEGACYPARSER_H__
+
+#include "GraphNode.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// @file LegacyParser.h
+/// @brief Reading back the #_#; string collectInformation returns
+/// @author Callum James
+/// @version 1.0
+/// @date 19/10/2026
+/// Revision History:
+/// Initial Version 19/10/2026
+/// @namespace LegacyParser
+/// @brief Splits an export into node records in a single pass over the string. Fields are found with memchr and
+/// handed back as std::string_views into the export, so nothing is allocated per field. The type names are mapped
+/// back with GenUtils::valueStringToType and GenUtils::nodeStringToType. The export only lists nodes, not how they
+/// were chained, so a rebuilt graph has every node joined straight to the end node.
+
+/// @struct LegacyRecord
+/// @brief A node read from an export, the names point into the export string
+struct LegacyRecord
+{
+    /// @brief Top level type of the node
+    VALUE_TYPE m_valueType;
+    /// @brief Bottom level type of the node
+    NODE_TYPE m_nodeType;
+    /// @brief Name of the node
+    std::string_view m_name;
+    /// @brief Short name of the node
+    std::string_view m_shortName;
+};
+
+namespace LegacyParser
+{
+    /// @brief Split an export into node records
+    /// @param [in] _export std::string_view - the whole #_#; string, it has to outlive the records
+    /// @param [out] _records std::vector<LegacyRecord>* - the vector to append the records to
+    /// @param [out] _error std::string* - the string to write the reason to if the export can not be read
+    /// @returns bool - false if the markers are missing, a record is cut short, a type name is unknown or the two
+    /// types of a record are not a pair the creation menus offer, such as the end node or an object with a number type
+    bool parse(std::string_view _export, std::vector<LegacyRecord> *_records, std::string *_error);
+}
+
+#endif /* __LEGACYPARSER_H__ */
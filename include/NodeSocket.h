@@ -19,6 +19,7 @@
 #define __NODESOCKET_H__
 
 #include <QGraphicsItem>
+#include <QSet>
 
 /// @file NodeSocket.h
 /// @brief A class for a single socket, this class knows which sockets and edges are connected
@@ -42,10 +43,14 @@ enum SOCKET_TYPE
 class GraphNode;
 class GraphEdge;
 class GraphScene;
+class PortBase;
 
 class NodeSocket : public QGraphicsItem
 {
 public:
+    /// @brief Item type used to identify sockets with qgraphicsitem_cast
+    enum { Type = UserType + 2 };
+
     /// @brief ctr
     /// @param [in] _type SOCKET_TYPE - the type of socket to create
     NodeSocket(SOCKET_TYPE _type);
@@ -64,6 +69,9 @@ public:
     NodeSocket(SOCKET_TYPE _type, QPointF _point, float _w = 10.0f, float _h = 10.0f);
     /// @brief dtr
     ~NodeSocket();
+    /// @brief Get the item type of the socket
+    /// @returns int
+    int type() const {return Type;}
     /// @brief initialise the class
     void init();
     /// @brief Add an edge to the socket
@@ -84,6 +92,11 @@ public:
     bool removeEdgeReference(GraphEdge *_edge);
     /// @brief remove all edges
     void removeAllEdges();
+    /// @brief Remove the references to a set of edges in a single pass, nothing is removed from the scene or deleted
+    /// @param [in] _edges QSet<GraphEdge*> - the edges to forget
+    void removeEdgeReferences(const QSet<GraphEdge*> &_edges);
+    /// @brief Forget every edge without removing or deleting them, used when the edges are freed by the scene
+    void clearEdgeReferences();
 
     /// @brief Test if a socket is over a point
     /// @param _point QPointF - the point to test
@@ -154,12 +167,28 @@ public:
     /// @brief Get the parent scene
     /// @returns GraphScene*
     GraphScene *getParentScene() {return m_parentScene;}
+    /// @brief Get the type of the socket
+    /// @returns SOCKET_TYPE
+    SOCKET_TYPE getSocketType() {return m_socketType;}
+    /// @brief Get the number of edges connected to the socket
+    /// @returns int
+    int numEdges() {return m_numEdges;}
+    /// @brief Get an edge connected to the socket
+    /// @param [in] _index int - index of the edge
+    /// @returns GraphEdge*
+    GraphEdge *edge(int _index) {return m_edges->at(_index);}
+    /// @brief Returns if an edge already joins this socket to another
+    /// @param [in] _socket NodeSocket* - the socket at the other end
+    /// @returns bool
+    bool isConnectedTo(NodeSocket *_socket) const {return m_peers.contains(_socket);}
+    /// @brief Set the typed port carried by the socket, the socket takes ownership
+    /// @param [in] _port PortBase* - the port
+    void setPort(PortBase *_port);
+    /// @brief Get the typed port carried by the socket
+    /// @returns PortBase* - NULL if the socket carries no value
+    PortBase *port() {return m_port;}
     /// @brief Print the socket information to console
     void printSocketInfo();
-    /// @brief Get all connected node details
-    /// @param [out] _vec std::vector<std::string>* - the vector to write information to
-    /// @returns bool
-    bool getConnectedNodeDetails(std::vector<std::string> *_vec);
 
 private:
     /// @brief The parent node
@@ -170,6 +199,10 @@ private:
     std::vector<GraphEdge*> *m_edges;
     /// @brief Number of edges connected to the socket
     int m_numEdges;
+    /// @brief The socket at the other end of each connected edge
+    QSet<NodeSocket*> m_peers;
+    /// @brief The typed value carried by the socket
+    PortBase *m_port;
     /// @brief The type of socket
     SOCKET_TYPE m_socketType;
     /// @brief Position of the socket
@@ -185,6 +218,10 @@ private:
     /// @param [out] _index int* - index to write to
     /// @returns bool
     bool findEdgeIndex(GraphEdge *_edge, int *_index);
+    /// @brief Get the socket at the other end of an edge
+    /// @param [in] _edge GraphEdge* - an edge connected to this socket
+    /// @returns NodeSocket*
+    NodeSocket *peerOf(GraphEdge *_edge);
 
 };
 
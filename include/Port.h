@@ -0,0 +1,243 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __PORT_H__
+#define __PORT_H__
+
+#include "GraphNode.h"
+
+#include <sstream>
+#include <string>
+
+/// @file Port.h
+/// @brief Typed values carried by sockets
+/// @author Callum James
+/// @version 1.0
+/// @date 19/10/2026
+/// Revision History:
+/// Initial Version 19/10/2026
+/// @class Port
+/// @brief Every socket carries a port holding a value of the native type of its node. input reads the value
+/// arriving on an inbound port straight from the outbound port its edge comes from, without formatting or parsing,
+/// for callers wanting one value at a time. Nothing in the library evaluates through it yet, BatchEvaluator moves
+/// whole columns between nodes and only reads value, the value a node nothing feeds repeats. Only integer to
+/// floating point widening is done on the way. The port types of the two ends are checked when an edge is created.
+/// Values only become strings through toString when exported.
+
+/// @enum PORT_TYPE
+/// @brief The native type a port carries
+enum PORT_TYPE
+{
+    PT_NONE = 0,
+    PT_INT,
+    PT_FLOAT,
+    PT_DOUBLE,
+    PT_BOOL,
+    PT_STRING,
+    PT_VECTOR,
+    PT_MATRIX,
+    PT_ANY
+};
+
+/// @struct PortVector
+/// @brief Four component vector, unused trailing components are zero. Components are doubles so every vector
+/// node type, up to four doubles and two or three longs, is held without losing precision
+struct Q_DECL_ALIGN(16) PortVector
+{
+    /// @brief The components
+    double m_v[4];
+};
+
+/// @struct PortMatrix
+/// @brief 4x4 matrix stored row by row, in doubles as Maya matrices are
+struct Q_DECL_ALIGN(16) PortMatrix
+{
+    /// @brief The elements
+    double m_m[16];
+};
+
+/// @struct PortTraits
+/// @brief The port type of each native type and how it is exported
+template <typename T> struct PortTraits;
+
+template <> struct PortTraits<int>
+{
+    static PORT_TYPE type() {return PT_INT;}
+    static double toNumber(const int &_value) {return _value;}
+    static int fromNumber(double _number) {return int(_number);}
+    static std::string toString(const int &_value) {std::ostringstream out; out<<_value; return out.str();}
+};
+
+template <> struct PortTraits<float>
+{
+    static PORT_TYPE type() {return PT_FLOAT;}
+    static double toNumber(const float &_value) {return _value;}
+    static float fromNumber(double _number) {return float(_number);}
+    static std::string toString(const float &_value) {std::ostringstream out; out<<_value; return out.str();}
+};
+
+template <> struct PortTraits<double>
+{
+    static PORT_TYPE type() {return PT_DOUBLE;}
+    static double toNumber(const double &_value) {return _value;}
+    static double fromNumber(double _number) {return _number;}
+    static std::string toString(const double &_value) {std::ostringstream out; out<<_value; return out.str();}
+};
+
+template <> struct PortTraits<bool>
+{
+    static PORT_TYPE type() {return PT_BOOL;}
+    static double toNumber(const bool &_value) {return _value ? 1.0 : 0.0;}
+    static bool fromNumber(double _number) {return _number != 0.0;}
+    static std::string toString(const bool &_value) {return _value ? "true" : "false";}
+};
+
+template <> struct PortTraits<std::string>
+{
+    static PORT_TYPE type() {return PT_STRING;}
+    static double toNumber(const std::string &) {return 0.0;}
+    static std::string fromNumber(double) {return std::string();}
+    static std::string toString(const std::string &_value) {return _value;}
+};
+
+template <> struct PortTraits<PortVector>
+{
+    static PORT_TYPE type() {return PT_VECTOR;}
+    static double toNumber(const PortVector &) {return 0.0;}
+    static PortVector fromNumber(double) {PortVector zero = {{0.0,0.0,0.0,0.0}}; return zero;}
+    static std::string toString(const PortVector &_value)
+    {
+        std::ostringstream out;
+        out<<_value.m_v[0]<<" "<<_value.m_v[1]<<" "<<_value.m_v[2]<<" "<<_value.m_v[3];
+        return out.str();
+    }
+};
+
+template <> struct PortTraits<PortMatrix>
+{
+    static PORT_TYPE type() {return PT_MATRIX;}
+    static double toNumber(const PortMatrix &) {return 0.0;}
+    static PortMatrix fromNumber(double)
+    {
+        PortMatrix identity = {{1.0,0.0,0.0,0.0, 0.0,1.0,0.0,0.0, 0.0,0.0,1.0,0.0, 0.0,0.0,0.0,1.0}};
+        return identity;
+    }
+    static std::string toString(const PortMatrix &_value)
+    {
+        std::ostringstream out;
+        for (int i = 0; i < 16; i++)
+        {
+            out<<(i ? " " : "")<<_value.m_m[i];
+        }
+        return out.str();
+    }
+};
+
+class PortBase
+{
+public:
+    /// @brief ctr
+    /// @param [in] _type PORT_TYPE - the native type carried
+    /// @param [in] _socket NodeSocket* - the socket the port belongs to
+    PortBase(PORT_TYPE _type, NodeSocket *_socket) : m_type(_type), m_socket(_socket) {}
+    /// @brief dtr
+    virtual ~PortBase() {}
+
+    /// @brief Get the native type carried
+    /// @returns PORT_TYPE
+    PORT_TYPE type() const {return m_type;}
+    /// @brief Get the socket the port belongs to
+    /// @returns NodeSocket*
+    NodeSocket *socket() const {return m_socket;}
+    /// @brief Returns if this port can take its value from another
+    /// @param [in] _source PortBase* - the outbound port the value would come from
+    /// @returns bool
+    bool accepts(const PortBase *_source) const;
+    /// @brief Get the number of ports feeding an inbound port
+    /// @returns int
+    int numInputs() const;
+    /// @brief Get a port feeding an inbound port
+    /// @param [in] _index int - which input, in edge order
+    /// @returns PortBase* - NULL if there is no such input or its socket has no port
+    PortBase *inputPort(int _index) const;
+    /// @brief Get the value as a number, used for widening between numeric ports
+    /// @returns double - 0 for non numeric ports
+    virtual double toNumber() const {return 0.0;}
+    /// @brief Format the value for export, the only place a value becomes a string
+    /// @returns std::string
+    virtual std::string toString() const {return std::string();}
+
+private:
+    /// @brief The native type carried
+    PORT_TYPE m_type;
+    /// @brief The socket the port belongs to
+    NodeSocket *m_socket;
+};
+
+template <typename T>
+class Port : public PortBase
+{
+public:
+    /// @brief ctr
+    /// @param [in] _socket NodeSocket* - the socket the port belongs to
+    explicit Port(NodeSocket *_socket) : PortBase(PortTraits<T>::type(),_socket), m_value() {}
+
+    /// @brief Get the value held by the port
+    /// @returns T
+    const T &value() const {return m_value;}
+    /// @brief Set the value held by the port
+    /// @param [in] _value T - the new value
+    void setValue(const T &_value) {m_value = _value;}
+    /// @brief Read the value arriving on an inbound port
+    /// @param [in] _index int - which input, in edge order
+    /// @returns T - a default value if there is no such input or it is not accepted
+    T input(int _index = 0) const
+    {
+        const PortBase *source = inputPort(_index);
+        if (!accepts(source)) return T();
+        if (source->type() == type())
+        {
+            return static_cast<const Port<T>*>(source)->value();
+        }
+        // only numeric widening gets past accepts
+        return PortTraits<T>::fromNumber(source->toNumber());
+    }
+
+    double toNumber() const {return PortTraits<T>::toNumber(m_value);}
+    std::string toString() const {return PortTraits<T>::toString(m_value);}
+
+private:
+    /// @brief The value held by the port
+    T m_value;
+};
+
+/// @namespace PortTypes
+/// @brief Mapping node types onto port types
+namespace PortTypes
+{
+    /// @brief Get the port type carried by a node type
+    /// @param [in] _type NODE_TYPE - the node type
+    /// @returns PORT_TYPE
+    PORT_TYPE forNode(NODE_TYPE _type);
+    /// @brief Create a port of the given type
+    /// @param [in] _type PORT_TYPE - the type to carry
+    /// @param [in] _socket NodeSocket* - the socket the port belongs to
+    /// @returns PortBase* - owned by the caller, NULL for PT_NONE
+    PortBase *create(PORT_TYPE _type, NodeSocket *_socket);
+}
+
+#endif /* __PORT_H__ */
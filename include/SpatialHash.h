@@ -0,0 +1,230 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __SPATIALHASH_H__
+#define __SPATIALHASH_H__
+
+#include <QHash>
+#include <QRectF>
+#include <QLineF>
+
+#include <vector>
+#include <algorithm>
+#include <math.h>
+
+/// @file SpatialHash.h
+/// @brief Uniform grid used to look up graph items by area without going through the scene
+/// @author Callum James
+/// @version 1.0
+/// @date 19/10/2026
+/// Revision History:
+/// Initial Version 19/10/2026
+/// @class SpatialHash
+/// @brief A sparse uniform grid keyed on cell coordinates. Every item is stored in each cell its rectangle
+/// covers so an area query only has to look at the cells the area touches. This is kept by the GraphScene for
+/// all nodes and edges, whether or not they currently live in the QGraphicsScene.
+
+template <typename T>
+class SpatialHash
+{
+public:
+    /// @brief ctr
+    /// @param [in] _cellSize qreal - width and height of a single cell in scene units
+    SpatialHash(qreal _cellSize = 256.0) : m_cellSize(_cellSize) {}
+
+    /// @brief Insert an item, or move it if it is already in the grid
+    /// @param [in] _item T - the item to store
+    /// @param [in] _rect QRectF - the area the item covers
+    void insert(T _item, const QRectF &_rect)
+    {
+        remove(_item);
+
+        std::vector<quint64> &cells = m_itemCells[_item];
+        int x0 = cellCoord(_rect.left());
+        int x1 = cellCoord(_rect.right());
+        int y0 = cellCoord(_rect.top());
+        int y1 = cellCoord(_rect.bottom());
+        for (int x = x0; x <= x1; x++)
+        {
+            for (int y = y0; y <= y1; y++)
+            {
+                quint64 key = cellKey(x,y);
+                m_cells[key].push_back(_item);
+                cells.push_back(key);
+            }
+        }
+        m_bounds = m_bounds.united(_rect);
+    }
+
+    /// @brief Insert a line shaped item as a chain of short boxes, or move it if it is already in the grid.
+    /// A long diagonal only occupies the cells along its length rather than every cell of its bounding rectangle
+    /// @param [in] _item T - the item to store
+    /// @param [in] _line QLineF - the line the item follows
+    /// @param [in] _pad qreal - distance either side of the line the item covers
+    void insertLine(T _item, const QLineF &_line, qreal _pad)
+    {
+        remove(_item);
+
+        std::vector<quint64> &cells = m_itemCells[_item];
+        // no piece is longer than a cell so each box only touches a handful of cells
+        int pieces = qMax(1,int(ceil(_line.length() / m_cellSize)));
+        for (int i = 0; i < pieces; i++)
+        {
+            QPointF a = _line.pointAt(qreal(i) / pieces);
+            QPointF b = _line.pointAt(qreal(i+1) / pieces);
+            QRectF box = QRectF(a,b).normalized().adjusted(-_pad,-_pad,_pad,_pad);
+
+            int x0 = cellCoord(box.left());
+            int x1 = cellCoord(box.right());
+            int y0 = cellCoord(box.top());
+            int y1 = cellCoord(box.bottom());
+            for (int x = x0; x <= x1; x++)
+            {
+                for (int y = y0; y <= y1; y++)
+                {
+                    quint64 key = cellKey(x,y);
+                    // neighbouring pieces share cells, only store the item once per cell
+                    if (std::find(cells.begin(),cells.end(),key) == cells.end())
+                    {
+                        m_cells[key].push_back(_item);
+                        cells.push_back(key);
+                    }
+                }
+            }
+            m_bounds = m_bounds.united(box);
+        }
+    }
+
+    /// @brief Remove an item from the grid
+    /// @param [in] _item T - the item to remove
+    void remove(T _item)
+    {
+        typename QHash<T, std::vector<quint64> >::iterator found = m_itemCells.find(_item);
+        if (found == m_itemCells.end()) return;
+
+        const std::vector<quint64> &cells = found.value();
+        for (int i = 0; i < int(cells.size()); i++)
+        {
+            typename QHash<quint64, std::vector<T> >::iterator cell = m_cells.find(cells.at(i));
+            if (cell == m_cells.end()) continue;
+
+            std::vector<T> &items = cell.value();
+            for (int j = 0; j < int(items.size()); j++)
+            {
+                if (items.at(j) == _item)
+                {
+                    items.at(j) = items.back();
+                    items.pop_back();
+                    break;
+                }
+            }
+            if (items.empty())
+            {
+                m_cells.erase(cell);
+            }
+        }
+        m_itemCells.erase(found);
+    }
+
+    /// @brief Returns if an item is stored in the grid
+    /// @param [in] _item T - the item to look for
+    /// @returns bool
+    bool contains(T _item) const {return m_itemCells.contains(_item);}
+
+    /// @brief Find every item stored in the cells an area touches, each item is reported once. The area is cut down
+    /// to the bounds of the grid first, and if it still covers more cells than are occupied the occupied cells are
+    /// walked instead, so a query far zoomed out costs no more than the number of items stored
+    /// @param [in] _rect QRectF - the area to query
+    /// @param [out] _result std::vector<T>* - vector to write the items to
+    void query(const QRectF &_rect, std::vector<T> *_result) const
+    {
+        if (m_cells.isEmpty()) return;
+
+        // clamped in scene units so a huge area can not overflow the cell coordinates
+        qreal left = qMax(_rect.left(),m_bounds.left());
+        qreal right = qMin(_rect.right(),m_bounds.right());
+        qreal top = qMax(_rect.top(),m_bounds.top());
+        qreal bottom = qMin(_rect.bottom(),m_bounds.bottom());
+        if (left > right || top > bottom) return;
+
+        int first = int(_result->size());
+        int x0 = cellCoord(left);
+        int x1 = cellCoord(right);
+        int y0 = cellCoord(top);
+        int y1 = cellCoord(bottom);
+        if (qint64(x1 - x0 + 1) * qint64(y1 - y0 + 1) > qint64(m_cells.size()))
+        {
+            for (typename QHash<quint64, std::vector<T> >::const_iterator cell = m_cells.constBegin(); cell != m_cells.constEnd(); ++cell)
+            {
+                int x = int(quint32(cell.key() >> 32));
+                int y = int(quint32(cell.key()));
+                if (x >= x0 && x <= x1 && y >= y0 && y <= y1)
+                {
+                    _result->insert(_result->end(),cell.value().begin(),cell.value().end());
+                }
+            }
+        }
+        else
+        {
+            for (int x = x0; x <= x1; x++)
+            {
+                for (int y = y0; y <= y1; y++)
+                {
+                    typename QHash<quint64, std::vector<T> >::const_iterator cell = m_cells.constFind(cellKey(x,y));
+                    if (cell != m_cells.constEnd())
+                    {
+                        _result->insert(_result->end(),cell.value().begin(),cell.value().end());
+                    }
+                }
+            }
+        }
+        // items spanning several cells are found more than once
+        std::sort(_result->begin()+first,_result->end());
+        _result->erase(std::unique(_result->begin()+first,_result->end()),_result->end());
+    }
+
+    /// @brief Get the area covered by everything that has been stored in the grid
+    /// @returns QRectF
+    QRectF bounds() const {return m_bounds;}
+    /// @brief Get the number of items in the grid
+    /// @returns int
+    int size() const {return m_itemCells.size();}
+    /// @brief Remove everything from the grid
+    void clear() {m_cells.clear(); m_itemCells.clear(); m_bounds = QRectF();}
+
+private:
+    /// @brief Size of a cell in scene units
+    qreal m_cellSize;
+    /// @brief Items stored in each occupied cell
+    QHash<quint64, std::vector<T> > m_cells;
+    /// @brief Cells occupied by each item, used when moving or removing it
+    QHash<T, std::vector<quint64> > m_itemCells;
+    /// @brief Area covered by every item ever inserted
+    QRectF m_bounds;
+
+    /// @brief Convert a scene coordinate to a cell coordinate
+    /// @param [in] _value qreal - the scene coordinate
+    /// @returns int
+    int cellCoord(qreal _value) const {return int(floor(_value / m_cellSize));}
+    /// @brief Pack two cell coordinates into a single hash key
+    /// @param [in] _x int - cell x coordinate
+    /// @param [in] _y int - cell y coordinate
+    /// @returns quint64
+    static quint64 cellKey(int _x, int _y) {return (quint64(quint32(_x)) << 32) | quint64(quint32(_y));}
+};
+
+#endif /* __SPATIALHASH_H__ */
@@ -0,0 +1,97 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __STATICLAYERCACHE_H__
+#define __STATICLAYERCACHE_H__
+
+#include <QObject>
+#include <QGraphicsView>
+#include <QGraphicsItem>
+#include <QFutureWatcher>
+#include <QImage>
+#include <QList>
+#include <QSet>
+#include <QTransform>
+
+#include <vector>
+
+/// @file StaticLayerCache.h
+/// @brief Tiled image cache of everything in the view that is not being moved
+/// @author Callum James
+/// @version 1.0
+/// @date 19/10/2026
+/// Revision History:
+/// Initial Version 19/10/2026
+/// @class StaticLayerCache
+/// @brief While nodes are dragged nothing else in the scene changes, so the visible part of the scene
+/// minus the moving items is recorded once and rendered into tiles on worker threads. Once the tiles are
+/// ready the static items are hidden and the view simply blits the tiles as its background, leaving only the
+/// moving items to be painted on each mouse move.
+
+class StaticLayerCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// @brief ctr
+    /// @param [in] _view QGraphicsView* - the view whose viewport is cached
+    /// @param [in] _parent QObject* - the parent object
+    explicit StaticLayerCache(QGraphicsView *_view, QObject *_parent = 0);
+    /// @brief dtr, waits for any tiles still being rendered
+    ~StaticLayerCache();
+
+    /// @brief Start building the cache for the current viewport, excluding the given items
+    /// @param [in] _dynamicItems std::vector<QGraphicsItem*> - top level items that will move while cached
+    void build(const std::vector<QGraphicsItem*> &_dynamicItems);
+    /// @brief Drop the cache, cancelling any pending tiles and showing the static items again
+    void release();
+    /// @brief Returns if the tiles are ready and valid for the current view transform
+    /// @returns bool
+    bool active();
+    /// @brief Draw the cached tiles covering an exposed area of the scene
+    /// @param [in] _painter QPainter* - the painter the view is drawing its background with
+    /// @param [in] _exposed QRectF - the exposed area in scene coordinates
+    void drawTiles(QPainter *_painter, const QRectF &_exposed);
+
+signals:
+    /// @brief Emitted once all tiles are rendered and the static items have been hidden
+    void ready();
+
+private slots:
+    /// @brief Called when the worker threads have finished rendering every tile
+    void tilesFinished();
+
+private:
+    /// @brief The view the cache belongs to
+    QGraphicsView *m_view;
+    /// @brief Watcher for the tile rendering jobs
+    QFutureWatcher<QImage> m_watcher;
+    /// @brief Viewport rectangle of each tile, in the same order as the rendered images
+    std::vector<QRect> m_tileRects;
+    /// @brief The rendered tiles
+    QList<QImage> m_tiles;
+    /// @brief Static items that are hidden while the tiles stand in for them
+    std::vector<QGraphicsItem*> m_staticItems;
+    /// @brief The viewport transform the tiles were rendered with
+    QTransform m_transform;
+    /// @brief If tiles are currently being rendered
+    bool m_building;
+    /// @brief If the tiles are ready and the static items hidden
+    bool m_active;
+};
+
+#endif /* __STATICLAYERCACHE_H__ */
@@ -0,0 +1,153 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __SUBGRAPH_H__
+#define __SUBGRAPH_H__
+
+#include "GraphNode.h"
+
+#include <QByteArray>
+#include <QMimeData>
+#include <QPointF>
+#include <QString>
+
+#include <string>
+#include <vector>
+
+/// @file Subgraph.h
+/// @brief A detached copy of part of a graph, used for the clipboard and for duplicating nodes
+/// @author Callum James
+/// @version 1.0
+/// @date 19/10/2026
+/// Revision History:
+/// Initial Version 19/10/2026
+/// @class Subgraph
+/// @brief Plain records of a set of nodes and the edges running between them. Node positions are stored relative
+/// to the top left of the set so it can be placed anywhere. Edges refer to nodes by their index in the set and to
+/// sockets by their index on the node. The records can be written to and read from a compact binary format.
+/// A whole graph including its end node is saved to file in the same format.
+
+/// @brief Mime type the binary format is put on the clipboard under
+#define SUBGRAPH_MIME_TYPE "application/x-nodegraph-subgraph"
+
+/// @struct SubgraphNode
+/// @brief Everything needed to recreate a node
+struct SubgraphNode
+{
+    /// @brief Top level type of the node
+    VALUE_TYPE m_valueType;
+    /// @brief Bottom level type of the node
+    NODE_TYPE m_nodeType;
+    /// @brief Position relative to the top left of the subgraph
+    QPointF m_point;
+    /// @brief Width of the node
+    qreal m_width;
+    /// @brief Base width of the node
+    qreal m_baseWidth;
+    /// @brief If the node can be edited
+    bool m_editable;
+    /// @brief If the node can be deleted
+    bool m_deletable;
+    /// @brief Number of inbound sockets
+    int m_numInbound;
+    /// @brief Number of outbound sockets
+    int m_numOutbound;
+    /// @brief Name of the node
+    std::string m_name;
+    /// @brief Short name of the node
+    std::string m_shortName;
+};
+
+/// @struct SubgraphEdge
+/// @brief An edge between two nodes of the subgraph
+struct SubgraphEdge
+{
+    /// @brief Index of the source node in the subgraph
+    int m_sourceNode;
+    /// @brief Index of the outbound socket on the source node
+    int m_sourceSocket;
+    /// @brief Index of the destination node in the subgraph
+    int m_destinationNode;
+    /// @brief Index of the inbound socket on the destination node
+    int m_destinationSocket;
+};
+
+class Subgraph
+{
+public:
+    /// @brief ctr
+    Subgraph();
+
+    /// @brief Record a set of nodes and every edge between two of them, edges leaving the set are dropped
+    /// @param [in] _nodes std::vector<GraphNode*> - the nodes to record
+    /// @param [in] _includeEnd bool - if the end node is recorded, only when saving a whole graph
+    void capture(const std::vector<GraphNode*> &_nodes, bool _includeEnd = false);
+    /// @brief Write the subgraph to the binary format
+    /// @returns QByteArray
+    QByteArray encode() const;
+    /// @brief Read a subgraph from the binary format, replacing anything already held
+    /// @param [in] _data QByteArray - the data to read
+    /// @param [in] _allowEnd bool - if a single end node may be read, only when loading a whole graph
+    /// @returns bool - false if the data is not a valid subgraph
+    bool decode(const QByteArray &_data, bool _allowEnd = false);
+    /// @brief Create mime data holding the subgraph, ownership passes to the caller
+    /// @returns QMimeData*
+    QMimeData *toMimeData() const;
+    /// @brief Read a subgraph from mime data
+    /// @param [in] _mime QMimeData* - the mime data to read
+    /// @returns bool - false if there is no valid subgraph in the mime data
+    bool fromMimeData(const QMimeData *_mime);
+    /// @brief Write the subgraph to a file
+    /// @param [in] _fileName QString - the file to write
+    /// @returns bool - false if the file could not be written
+    bool save(const QString &_fileName) const;
+    /// @brief Read a subgraph from a file, replacing anything already held
+    /// @param [in] _fileName QString - the file to read
+    /// @returns bool - false if the file could not be read or is not a valid subgraph
+    bool load(const QString &_fileName);
+
+    /// @brief Make a record of a single node
+    /// @param [in] _node GraphNode* - the node to record
+    /// @param [in] _origin QPointF - point the recorded position is made relative to
+    /// @returns SubgraphNode
+    static SubgraphNode recordNode(GraphNode *_node, QPointF _origin = QPointF(0.0,0.0));
+    /// @brief Add a node record, used when building a subgraph from something other than the scene
+    /// @param [in] _node SubgraphNode - the record, its position relative to the top left of the subgraph
+    void addNode(const SubgraphNode &_node) {m_nodes.push_back(_node);}
+    /// @brief Returns if there are no nodes in the subgraph
+    /// @returns bool
+    bool isEmpty() const {return m_nodes.empty();}
+    /// @brief Get the recorded nodes
+    /// @returns const std::vector<SubgraphNode>&
+    const std::vector<SubgraphNode> &nodes() const {return m_nodes;}
+    /// @brief Get the recorded edges
+    /// @returns const std::vector<SubgraphEdge>&
+    const std::vector<SubgraphEdge> &edges() const {return m_edges;}
+    /// @brief Get the scene position the subgraph was captured at
+    /// @returns QPointF
+    QPointF origin() const {return m_origin;}
+
+private:
+    /// @brief The recorded nodes
+    std::vector<SubgraphNode> m_nodes;
+    /// @brief The recorded edges
+    std::vector<SubgraphEdge> m_edges;
+    /// @brief Top left of the captured nodes in scene coordinates
+    QPointF m_origin;
+};
+
+#endif /* __SUBGRAPH_H__ */
@@ -0,0 +1,132 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __TASKSCHEDULER_H__
+#define __TASKSCHEDULER_H__
+
+#include <QRunnable>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
+
+#include <deque>
+#include <vector>
+
+/// @file TaskScheduler.h
+/// @brief Runs a graph of dependent tasks across a set of worker threads
+/// @author Callum James
+/// @version 1.0
+/// @date 19/10/2026
+/// Revision History:
+/// Initial Version 19/10/2026
+/// @class TaskScheduler
+/// @brief Work stealing scheduler for tasks with dependencies between them. Each worker has its own queue and
+/// takes its newest task first, so a task made ready by one just finished tends to run on the same thread while
+/// its inputs are still in cache. A worker with nothing left takes the oldest task from another worker's queue.
+/// A task is queued once every task it depends on has run. The dependencies must not form a cycle.
+
+class TaskWorker;
+
+class TaskScheduler
+{
+public:
+    /// @brief ctr
+    /// @param [in] _threads int - number of worker threads, 0 uses one per core
+    explicit TaskScheduler(int _threads = 0);
+    /// @brief dtr, stops and joins the workers
+    ~TaskScheduler();
+
+    /// @brief Add a task to the next execute, the scheduler does not take ownership
+    /// @param [in] _task QRunnable* - the task
+    /// @returns int - handle used to add dependencies
+    int addTask(QRunnable *_task);
+    /// @brief Stop a task running until another has finished
+    /// @param [in] _task int - handle of the task that must wait
+    /// @param [in] _dependency int - handle of the task it waits for
+    void addDependency(int _task, int _dependency);
+    /// @brief Run every added task and wait for them all to finish, the tasks are then forgotten
+    void execute();
+    /// @brief Get the number of worker threads
+    /// @returns int
+    int threadCount() const {return int(m_workers.size());}
+    /// @brief Get the number of tasks each worker took from another worker during the last execute
+    /// @returns int
+    int stolenCount() const {return m_stolen.load();}
+
+    /// @brief The loop run by each worker thread
+    /// @param [in] _worker int - index of the worker
+    void workerLoop(int _worker);
+
+private:
+    /// @brief A task and the tasks waiting on it
+    struct Entry
+    {
+        /// @brief The work to do
+        QRunnable *m_task;
+        /// @brief Tasks that depend on this one
+        std::vector<int> m_dependents;
+        /// @brief Number of dependencies still to finish
+        QAtomicInt m_waiting;
+    };
+
+    /// @brief The tasks of one worker
+    struct Queue
+    {
+        /// @brief Guards m_tasks
+        QMutex m_mutex;
+        /// @brief Ready tasks, the owner takes from the back and thieves from the front
+        std::deque<int> m_tasks;
+    };
+
+    /// @brief Every task of the current execute
+    std::vector<Entry> m_entries;
+    /// @brief One queue per worker
+    std::vector<Queue*> m_queues;
+    /// @brief The worker threads
+    std::vector<TaskWorker*> m_workers;
+    /// @brief Guards sleeping and waking
+    QMutex m_lock;
+    /// @brief Signalled when tasks are queued or the workers should stop
+    QWaitCondition m_wake;
+    /// @brief Signalled when the last task finishes
+    QWaitCondition m_done;
+    /// @brief Tasks sitting in a queue
+    QAtomicInt m_queued;
+    /// @brief Tasks not yet finished
+    QAtomicInt m_remaining;
+    /// @brief Tasks taken from another worker's queue
+    QAtomicInt m_stolen;
+    /// @brief If the workers should stop
+    bool m_quit;
+
+    /// @brief Queue a ready task on a worker
+    /// @param [in] _worker int - the worker to queue on
+    /// @param [in] _task int - the task
+    void push(int _worker, int _task);
+    /// @brief Take a task, from the worker's own queue if it has one, otherwise from another worker
+    /// @param [in] _worker int - the worker looking for work
+    /// @returns int - the task, -1 if every queue is empty
+    int take(int _worker);
+    /// @brief Run a task then queue any task it was the last dependency of
+    /// @param [in] _worker int - the worker running it
+    /// @param [in] _task int - the task
+    void run(int _worker, int _task);
+    /// @brief Run every task on the calling thread in dependency order, used when there is a single worker
+    void executeSerial();
+};
+
+#endif /* __TASKSCHEDULER_H__ */
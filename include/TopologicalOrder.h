@@ -0,0 +1,96 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __TOPOLOGICALORDER_H__
+#define __TOPOLOGICALORDER_H__
+
+#include "GraphNode.h"
+
+#include <QHash>
+
+#include <vector>
+
+/// @file TopologicalOrder.h
+/// @brief Topological order of the graph kept up to date as edges are added
+/// @author Callum James
+/// @version 1.0
+/// @date 19/10/2026
+/// Revision History:
+/// Initial Version 19/10/2026
+/// @class TopologicalOrder
+/// @brief Keeps every node in an order where each edge goes from an earlier node to a later one, using the
+/// Pearce-Kelly algorithm. When a new edge already agrees with the order nothing needs doing. Otherwise only the
+/// nodes lying between its two ends in the order are searched and reordered, and if the search from the
+/// destination reaches the source the edge would close a cycle and is refused.
+
+class TopologicalOrder
+{
+public:
+    /// @brief ctr
+    TopologicalOrder();
+
+    /// @brief Add a node to the end of the order
+    /// @param [in] _node GraphNode* - the new node
+    void addNode(GraphNode *_node);
+    /// @brief Remove a node from the order, its edges must already be gone or about to be removed with it
+    /// @param [in] _node GraphNode* - the node to remove
+    void removeNode(GraphNode *_node);
+    /// @brief Returns if an edge from one node to another can be added without creating a cycle
+    /// @param [in] _from GraphNode* - the source node of the edge
+    /// @param [in] _to GraphNode* - the destination node of the edge
+    /// @returns bool
+    bool canConnect(GraphNode *_from, GraphNode *_to);
+    /// @brief Update the order for an edge about to be added from one node to another
+    /// @param [in] _from GraphNode* - the source node of the edge
+    /// @param [in] _to GraphNode* - the destination node of the edge
+    /// @returns bool - false, leaving the order untouched, if the edge would create a cycle
+    bool connect(GraphNode *_from, GraphNode *_to);
+    /// @brief Get every node so that each edge goes from an earlier node to a later one
+    /// @returns std::vector<GraphNode*>
+    std::vector<GraphNode*> order() const;
+    /// @brief Get the position of a node in the order, only meaningful for comparing two nodes
+    /// @param [in] _node GraphNode* - the node
+    /// @returns int - -1 if the node is not in the order
+    int index(GraphNode *_node) const {return m_index.value(_node,-1);}
+
+private:
+    /// @brief Nodes by position, removed nodes leave a NULL until the order is compacted
+    std::vector<GraphNode*> m_order;
+    /// @brief Position of each node
+    QHash<GraphNode*, int> m_index;
+    /// @brief Number of NULL entries in m_order
+    int m_holes;
+
+    /// @brief Collect the nodes reachable from a node whose position is below a bound
+    /// @param [in] _start GraphNode* - the node to search from
+    /// @param [in] _upper int - position of the edge source, reaching it means a cycle
+    /// @param [out] _found std::vector<GraphNode*>* - the nodes reached
+    /// @returns bool - false if the edge source was reached
+    bool searchForward(GraphNode *_start, int _upper, std::vector<GraphNode*> *_found);
+    /// @brief Collect the nodes that reach a node whose position is above a bound
+    /// @param [in] _start GraphNode* - the node to search from
+    /// @param [in] _lower int - position of the edge destination
+    /// @param [out] _found std::vector<GraphNode*>* - the nodes reached
+    void searchBackward(GraphNode *_start, int _lower, std::vector<GraphNode*> *_found);
+    /// @brief Sort nodes by their current position
+    /// @param [in,out] _nodes std::vector<GraphNode*>* - the nodes to sort
+    void sortByIndex(std::vector<GraphNode*> *_nodes);
+    /// @brief Remove the holes left by removed nodes
+    void compact();
+};
+
+#endif /* __TOPOLOGICALORDER_H__ */
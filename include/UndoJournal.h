@@ -0,0 +1,194 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __UNDOJOURNAL_H__
+#define __UNDOJOURNAL_H__
+
+#include "Subgraph.h"
+
+#include <QPointF>
+
+#include <deque>
+#include <string>
+#include <vector>
+
+/// @file UndoJournal.h
+/// @brief Undo and redo history of the graph stored as small deltas
+/// @author Callum James
+/// @version 1.0
+/// @date 19/10/2026
+/// Revision History:
+/// Initial Version 19/10/2026
+/// @class UndoJournal
+/// @brief Every user action is recorded as an entry holding only what changed, referring to nodes by their stable
+/// id so entries stay valid when nodes are deleted and recreated. Consecutive edits of the same name are merged into
+/// a single entry, and the oldest entries are dropped once the history grows past its byte budget.
+
+class GraphScene;
+
+/// @struct JournalNode
+/// @brief A node created or removed by an entry
+struct JournalNode
+{
+    /// @brief Id of the node
+    quint32 m_id;
+    /// @brief Everything needed to recreate the node, the point is in scene coordinates
+    SubgraphNode m_record;
+};
+
+/// @struct JournalEdge
+/// @brief An edge added or removed by an entry
+struct JournalEdge
+{
+    /// @brief Id of the source node
+    quint32 m_sourceNode;
+    /// @brief Id of the destination node
+    quint32 m_destinationNode;
+    /// @brief Index of the outbound socket on the source node
+    quint16 m_sourceSocket;
+    /// @brief Index of the inbound socket on the destination node
+    quint16 m_destinationSocket;
+};
+
+/// @struct JournalMove
+/// @brief A node that was moved
+struct JournalMove
+{
+    /// @brief Id of the node
+    quint32 m_id;
+    /// @brief Position before the move
+    QPointF m_from;
+    /// @brief Position after the move
+    QPointF m_to;
+};
+
+/// @struct JournalRename
+/// @brief A node whose name or short name was changed
+struct JournalRename
+{
+    /// @brief Id of the node
+    quint32 m_id;
+    /// @brief Name before the change
+    std::string m_oldName;
+    /// @brief Name after the change
+    std::string m_newName;
+    /// @brief Short name before the change
+    std::string m_oldShortName;
+    /// @brief Short name after the change
+    std::string m_newShortName;
+};
+
+/// @struct JournalEntry
+/// @brief A single undoable step
+struct JournalEntry
+{
+    /// @brief Nodes created by the step
+    std::vector<JournalNode> m_createdNodes;
+    /// @brief Nodes removed by the step
+    std::vector<JournalNode> m_removedNodes;
+    /// @brief Edges added by the step
+    std::vector<JournalEdge> m_addedEdges;
+    /// @brief Edges removed by the step, including those that went with removed nodes
+    std::vector<JournalEdge> m_removedEdges;
+    /// @brief Nodes moved by the step
+    std::vector<JournalMove> m_moves;
+    /// @brief Nodes renamed by the step
+    std::vector<JournalRename> m_renames;
+    /// @brief Estimated memory used by the entry
+    qint64 m_bytes;
+};
+
+class UndoJournal
+{
+public:
+    /// @brief ctr
+    /// @param [in] _scene GraphScene* - the scene the journal replays changes on
+    UndoJournal(GraphScene *_scene);
+
+    /// @brief Record a step, clearing anything that could be redone
+    /// @param [in] _entry JournalEntry - the step to record
+    void record(const JournalEntry &_entry);
+    /// @brief Record a name change, merged into the previous step if that was a name change of the same node
+    /// @param [in] _rename JournalRename - the name change
+    void recordRename(const JournalRename &_rename);
+    /// @brief Stop the next step being merged into the current one
+    void seal() {m_sealed = true;}
+
+    /// @brief Undo the most recent step
+    /// @returns bool - false if there was nothing to undo
+    bool undo();
+    /// @brief Redo the most recently undone step
+    /// @returns bool - false if there was nothing to redo
+    bool redo();
+    /// @brief Returns if there is a step to undo
+    /// @returns bool
+    bool canUndo() const {return !m_undo.empty();}
+    /// @brief Returns if there is a step to redo
+    /// @returns bool
+    bool canRedo() const {return !m_redo.empty();}
+    /// @brief Forget every step
+    void clear();
+
+    /// @brief Stop recording, used while the scene is changed by something that should not be undone
+    void suspend() {m_suspended++;}
+    /// @brief Resume recording after a suspend
+    void resume() {if (m_suspended > 0) m_suspended--;}
+    /// @brief Returns if changes are currently being recorded
+    /// @returns bool
+    bool recording() const {return m_suspended == 0;}
+
+    /// @brief Set the maximum memory the history may use, the oldest steps are dropped to stay within it
+    /// @param [in] _bytes qint64 - the budget in bytes
+    void setByteBudget(qint64 _bytes);
+    /// @brief Get the maximum memory the history may use
+    /// @returns qint64
+    qint64 byteBudget() const {return m_budget;}
+    /// @brief Get the estimated memory used by the history
+    /// @returns qint64
+    qint64 byteUsage() const {return m_usage;}
+
+private:
+    /// @brief The scene changes are replayed on
+    GraphScene *m_scene;
+    /// @brief Steps that can be undone, most recent at the back
+    std::deque<JournalEntry> m_undo;
+    /// @brief Steps that can be redone, most recent at the back
+    std::deque<JournalEntry> m_redo;
+    /// @brief Maximum bytes for the whole history
+    qint64 m_budget;
+    /// @brief Estimated bytes used by the whole history
+    qint64 m_usage;
+    /// @brief Nesting depth of suspend calls
+    int m_suspended;
+    /// @brief If the next rename must start a new step
+    bool m_sealed;
+
+    /// @brief Replay a step backwards
+    /// @param [in] _entry JournalEntry - the step to revert
+    void revert(const JournalEntry &_entry);
+    /// @brief Replay a step forwards
+    /// @param [in] _entry JournalEntry - the step to apply
+    void apply(const JournalEntry &_entry);
+    /// @brief Drop the oldest steps until within budget
+    void trim();
+    /// @brief Estimate the memory used by a step
+    /// @param [in] _entry JournalEntry - the step to measure
+    /// @returns qint64
+    static qint64 measure(const JournalEntry &_entry);
+};
+
+#endif /* __UNDOJOURNAL_H__ */
@@ -34,22 +34,34 @@
 
 #include "GraphNode.h"
 
+#include <string>
+#include <string_view>
+#include <vector>
+
 /// @namespace GenUtils
 /// @brief A custom namespace that contains simple generic utility functions
 namespace GenUtils
 {
     /// @brief Convert a node type to its string equivalent
     /// @param [in] _type NODE_TYPE - the type to convert
-    /// @returns std::string
-    std::string nodeTypeToString(NODE_TYPE _type);
+    /// @returns std::string_view - refers to a static null terminated name, nothing is allocated
+    std::string_view nodeTypeToString(NODE_TYPE _type);
     /// @brief Convert a string name to a NODE_TYPE
-    /// @param [in] _type std::string - name to convert
+    /// @param [in] _type std::string_view - name to convert
     /// @returns NODE_TYPE
-    NODE_TYPE nodeStringToType(std::string _type);
+    NODE_TYPE nodeStringToType(std::string_view _type);
     /// @brief Convert top level type to string
     /// @param [in] _type VALUE_TYPE - type to convert
-    /// @returns std::string
-    std::string valueTypeToString(VALUE_TYPE _type);
+    /// @returns std::string_view - refers to a static null terminated name, nothing is allocated
+    std::string_view valueTypeToString(VALUE_TYPE _type);
+    /// @brief Convert a top level type name back to its type
+    /// @param [in] _type std::string_view - name to convert
+    /// @returns VALUE_TYPE - VT_NOTYPE if the name is not known
+    VALUE_TYPE valueStringToType(std::string_view _type);
+    /// @brief Check that no gathered export token is repeated, the token following each -- separator is not compared
+    /// @param [in] _tokens std::vector<std::string> - the tokens to check
+    /// @returns bool - false if any token appears twice
+    bool tokensUnique(const std::vector<std::string> &_tokens);
 }
 
 #endif /* __UTILITIES_H__ */
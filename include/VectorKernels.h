@@ -0,0 +1,103 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __VECTORKERNELS_H__
+#define __VECTORKERNELS_H__
+
+#include "Port.h"
+
+/// @file VectorKernels.h
+/// @brief Batched vector and matrix maths for vector and matrix ports
+/// @author Callum James
+/// @version 1.0
+/// @date 19/10/2026
+/// Revision History:
+/// Initial Version 19/10/2026
+/// @namespace VectorKernels
+/// @brief Each kernel runs over a whole batch of values using SSE3, two doubles at a time, when the library is
+/// built with it, and has a scalar version doing the same operations in the same order so both give bit for bit
+/// the same results. The library is built with -ffp-contract=off so no multiply and add is fused into one. Vectors
+/// are row vectors so transform multiplies a vector by a row major matrix, v * M, as Maya does.
+
+/// @namespace VectorKernels
+/// @brief Batched vector and matrix operations
+namespace VectorKernels
+{
+    /// @brief Add two batches of vectors
+    /// @param [in] _a PortVector* - the first vectors
+    /// @param [in] _b PortVector* - the second vectors
+    /// @param [out] _out PortVector* - the sums, may be either input
+    /// @param [in] _count int - number of vectors
+    void add(const PortVector *_a, const PortVector *_b, PortVector *_out, int _count);
+    /// @brief Scale a batch of vectors
+    /// @param [in] _a PortVector* - the vectors
+    /// @param [in] _scale double - the scale
+    /// @param [out] _out PortVector* - the scaled vectors, may be the input
+    /// @param [in] _count int - number of vectors
+    void scale(const PortVector *_a, double _scale, PortVector *_out, int _count);
+    /// @brief Dot product of two batches of vectors over all four components
+    /// @param [in] _a PortVector* - the first vectors
+    /// @param [in] _b PortVector* - the second vectors
+    /// @param [out] _out double* - the products
+    /// @param [in] _count int - number of vectors
+    void dot(const PortVector *_a, const PortVector *_b, double *_out, int _count);
+    /// @brief Cross product of the first three components of two batches of vectors, the fourth is zero
+    /// @param [in] _a PortVector* - the first vectors
+    /// @param [in] _b PortVector* - the second vectors
+    /// @param [out] _out PortVector* - the products, must not be either input
+    /// @param [in] _count int - number of vectors
+    void cross(const PortVector *_a, const PortVector *_b, PortVector *_out, int _count);
+    /// @brief Multiply two batches of matrices, _a * _b
+    /// @param [in] _a PortMatrix* - the left matrices
+    /// @param [in] _b PortMatrix* - the right matrices
+    /// @param [out] _out PortMatrix* - the products, must not be either input
+    /// @param [in] _count int - number of matrices
+    void multiply(const PortMatrix *_a, const PortMatrix *_b, PortMatrix *_out, int _count);
+    /// @brief Transform a batch of vectors by a batch of matrices, _v * _m
+    /// @param [in] _v PortVector* - the vectors
+    /// @param [in] _m PortMatrix* - the matrices
+    /// @param [out] _out PortVector* - the transformed vectors, must not be the input
+    /// @param [in] _count int - number of vectors
+    void transform(const PortVector *_v, const PortMatrix *_m, PortVector *_out, int _count);
+
+    /// @brief Scalar version of add
+    void addScalar(const PortVector *_a, const PortVector *_b, PortVector *_out, int _count);
+    /// @brief Scalar version of scale
+    void scaleScalar(const PortVector *_a, double _scale, PortVector *_out, int _count);
+    /// @brief Scalar version of dot
+    void dotScalar(const PortVector *_a, const PortVector *_b, double *_out, int _count);
+    /// @brief Scalar version of cross
+    void crossScalar(const PortVector *_a, const PortVector *_b, PortVector *_out, int _count);
+    /// @brief Scalar version of multiply
+    void multiplyScalar(const PortMatrix *_a, const PortMatrix *_b, PortMatrix *_out, int _count);
+    /// @brief Scalar version of transform
+    void transformScalar(const PortVector *_v, const PortMatrix *_m, PortVector *_out, int _count);
+
+    /// @brief Returns if the SSE3 kernels are compiled in
+    /// @returns bool
+    bool simd();
+    /// @brief Run every kernel and its scalar version over the same values and compare the results bit for bit
+    /// @returns bool - false if any result differs
+    bool verify();
+    /// @brief Time every kernel over a batch of values
+    /// @param [in] _count int - number of values in the batch
+    /// @param [in] _repeats int - number of times to run each kernel
+    /// @returns double - values processed per second, over all kernels
+    double benchmark(int _count, int _repeats);
+}
+
+#endif /* __VECTORKERNELS_H__ */
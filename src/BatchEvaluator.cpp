@@ -0,0 +1,353 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "BatchEvaluator.h"
+#include "DataflowEngine.h"
+#include "GraphEdge.h"
+#include "GraphScene.h"
+#include "VectorKernels.h"
+
+#include <iostream>
+
+void BatchOps::combine(std::vector<int> *_total, const std::vector<int> &_input)
+{
+    for (int i = 0; i < int(_input.size()); i++)
+    {
+        (*_total)[i] += _input[i];
+    }
+}
+
+void BatchOps::combine(std::vector<float> *_total, const std::vector<float> &_input)
+{
+    for (int i = 0; i < int(_input.size()); i++)
+    {
+        (*_total)[i] += _input[i];
+    }
+}
+
+void BatchOps::combine(std::vector<double> *_total, const std::vector<double> &_input)
+{
+    for (int i = 0; i < int(_input.size()); i++)
+    {
+        (*_total)[i] += _input[i];
+    }
+}
+
+void BatchOps::combine(std::vector<bool> *_total, const std::vector<bool> &_input)
+{
+    for (int i = 0; i < int(_input.size()); i++)
+    {
+        (*_total)[i] = (*_total)[i] || _input[i];
+    }
+}
+
+void BatchOps::combine(std::vector<std::string> *_total, const std::vector<std::string> &_input)
+{
+    for (int i = 0; i < int(_input.size()); i++)
+    {
+        (*_total)[i] += _input[i];
+    }
+}
+
+void BatchOps::combine(std::vector<PortVector> *_total, const std::vector<PortVector> &_input)
+{
+    if (_input.empty()) return;
+    VectorKernels::add(&(*_total)[0],&_input[0],&(*_total)[0],int(_input.size()));
+}
+
+void BatchOps::combine(std::vector<PortMatrix> *_total, const std::vector<PortMatrix> &_input)
+{
+    if (_input.empty()) return;
+    // the product cannot be written over either side
+    std::vector<PortMatrix> product(_input.size());
+    VectorKernels::multiply(&(*_total)[0],&_input[0],&product[0],int(_input.size()));
+    _total->swap(product);
+}
+
+ColumnBase *ColumnBase::create(PORT_TYPE _type)
+{
+    switch (_type)
+    {
+        case(PT_INT): return new Column<int>();
+        case(PT_FLOAT): return new Column<float>();
+        case(PT_DOUBLE): return new Column<double>();
+        case(PT_BOOL): return new Column<bool>();
+        case(PT_STRING): return new Column<std::string>();
+        case(PT_VECTOR): return new Column<PortVector>();
+        case(PT_MATRIX): return new Column<PortMatrix>();
+        default: return NULL;
+    }
+}
+
+BatchEvaluator::BatchEvaluator(GraphScene *_scene, GraphNode *_end)
+{
+    m_scene = _scene;
+    m_end = _end ? _end->id() : 0;
+    m_rows = 0;
+}
+
+BatchEvaluator::~BatchEvaluator()
+{
+    clear();
+}
+
+bool BatchEvaluator::setOperation(GraphNode *_node, BATCH_OPERATION _operation, double _scale)
+{
+    if (!_node) return false;
+    if (_operation != BO_COMBINE && valueType(_node) != operationType(_operation)) return false;
+
+    BatchOperation operation;
+    operation.m_operation = _operation;
+    operation.m_scale = _scale;
+    m_operations.insert(_node->id(),operation);
+    return true;
+}
+
+bool BatchEvaluator::run()
+{
+    clearOutputs();
+    m_rows = 0;
+
+    GraphNode *end = m_scene ? m_scene->nodeById(m_end) : NULL;
+    if (!end)
+    {
+#ifdef DEBUG
+        std::cerr<<"The end node of the batch is no longer in the scene"<<std::endl;
+#endif
+        return false;
+    }
+
+    // every input column has to describe the same records
+    int rows = -1;
+    for (QHash<quint32, ColumnBase*>::const_iterator it = m_inputs.constBegin(); it != m_inputs.constEnd(); ++it)
+    {
+        if (rows >= 0 && it.value()->rows() != rows)
+        {
+#ifdef DEBUG
+            std::cerr<<"Batch input columns have different lengths, "<<rows<<" and "<<it.value()->rows()<<std::endl;
+#endif
+            return false;
+        }
+        rows = it.value()->rows();
+    }
+    m_rows = rows < 0 ? 0 : rows;
+
+    // the graph may have been edited since the last run so it is walked again, once per batch not per record
+    std::vector<GraphNode*> order;
+    DataflowEngine::upstreamOrder(end,&order);
+    m_outputs.reserve(int(order.size()));
+
+    for (int i = 0; i < int(order.size()); i++)
+    {
+        GraphNode *node = order.at(i);
+        PortBase *value = valuePort(node);
+        ColumnBase *column = value ? ColumnBase::create(value->type()) : NULL;
+        if (!column) continue;
+        m_outputs.insert(node->id(),column);
+
+        ColumnBase *input = m_inputs.value(node->id(),NULL);
+        if (input)
+        {
+            column->assign(input);
+            continue;
+        }
+
+        QHash<quint32, BatchOperation>::const_iterator operation = m_operations.constFind(node->id());
+        if (operation != m_operations.constEnd() && operation.value().m_operation != BO_COMBINE)
+        {
+            if (!operate(node,operation.value(),column))
+            {
+                column->broadcast(value,m_rows);
+            }
+            continue;
+        }
+
+        // everything upstream has already been computed, fold each accepted input in socket then edge order
+        bool fed = false;
+        for (int j = 0; j < node->numInboundSockets(); j++)
+        {
+            NodeSocket *socket = node->inboundSocket(j);
+            for (int k = 0; k < socket->numEdges(); k++)
+            {
+                GraphEdge *edge = socket->edge(k);
+                ColumnBase *source = m_outputs.value(edge->sourceNode()->id(),NULL);
+                if (!source || !value->accepts(edge->sourceSocket()->port())) continue;
+                if (fed)
+                {
+                    column->combine(source);
+                }
+                else
+                {
+                    column->assign(source);
+                    fed = true;
+                }
+            }
+        }
+        if (!fed)
+        {
+            column->broadcast(value,m_rows);
+        }
+    }
+    return true;
+}
+
+void BatchEvaluator::clear()
+{
+    clearOutputs();
+    for (QHash<quint32, ColumnBase*>::const_iterator it = m_inputs.constBegin(); it != m_inputs.constEnd(); ++it)
+    {
+        delete it.value();
+    }
+    m_inputs.clear();
+    m_operations.clear();
+    m_rows = 0;
+}
+
+void BatchEvaluator::setInputColumn(quint32 _id, ColumnBase *_column)
+{
+    delete m_inputs.value(_id,NULL);
+    m_inputs.insert(_id,_column);
+}
+
+void BatchEvaluator::clearOutputs()
+{
+    for (QHash<quint32, ColumnBase*>::const_iterator it = m_outputs.constBegin(); it != m_outputs.constEnd(); ++it)
+    {
+        delete it.value();
+    }
+    m_outputs.clear();
+}
+
+bool BatchEvaluator::operate(GraphNode *_node, const BatchOperation &_operation, ColumnBase *_column) const
+{
+    // the node may have been changed since the operation was chosen
+    if (_column->type() != operationType(_operation.m_operation)) return false;
+
+    // the vector and matrix columns arriving, in socket then edge order
+    std::vector<const std::vector<PortVector>*> vectors;
+    std::vector<const std::vector<PortMatrix>*> matrices;
+    for (int j = 0; j < _node->numInboundSockets(); j++)
+    {
+        NodeSocket *socket = _node->inboundSocket(j);
+        for (int k = 0; k < socket->numEdges(); k++)
+        {
+            ColumnBase *source = m_outputs.value(socket->edge(k)->sourceNode()->id(),NULL);
+            if (!source || source->rows() != m_rows || m_rows == 0) continue;
+            if (source->type() == PT_VECTOR)
+            {
+                vectors.push_back(&static_cast<const Column<PortVector>*>(source)->values());
+            }
+            else if (source->type() == PT_MATRIX)
+            {
+                matrices.push_back(&static_cast<const Column<PortMatrix>*>(source)->values());
+            }
+        }
+    }
+
+    switch (_operation.m_operation)
+    {
+        case(BO_ADD):
+        case(BO_SCALE):
+        {
+            if (vectors.empty()) return false;
+            std::vector<PortVector> sum = *vectors.at(0);
+            for (int i = 1; i < int(vectors.size()); i++)
+            {
+                VectorKernels::add(&sum[0],&(*vectors.at(i))[0],&sum[0],m_rows);
+            }
+            if (_operation.m_operation == BO_SCALE)
+            {
+                VectorKernels::scale(&sum[0],_operation.m_scale,&sum[0],m_rows);
+            }
+            static_cast<Column<PortVector>*>(_column)->swapValues(&sum);
+            return true;
+        }
+        case(BO_DOT):
+        {
+            if (vectors.size() < 2) return false;
+            std::vector<double> products(m_rows);
+            VectorKernels::dot(&(*vectors.at(0))[0],&(*vectors.at(1))[0],&products[0],m_rows);
+            static_cast<Column<double>*>(_column)->swapValues(&products);
+            return true;
+        }
+        case(BO_CROSS):
+        {
+            if (vectors.size() < 2) return false;
+            // the product cannot be written over either side
+            std::vector<PortVector> product = *vectors.at(0);
+            std::vector<PortVector> next(m_rows);
+            for (int i = 1; i < int(vectors.size()); i++)
+            {
+                VectorKernels::cross(&product[0],&(*vectors.at(i))[0],&next[0],m_rows);
+                product.swap(next);
+            }
+            static_cast<Column<PortVector>*>(_column)->swapValues(&product);
+            return true;
+        }
+        case(BO_MULTIPLY):
+        {
+            if (matrices.empty()) return false;
+            std::vector<PortMatrix> product = *matrices.at(0);
+            std::vector<PortMatrix> next(m_rows);
+            for (int i = 1; i < int(matrices.size()); i++)
+            {
+                VectorKernels::multiply(&product[0],&(*matrices.at(i))[0],&next[0],m_rows);
+                product.swap(next);
+            }
+            static_cast<Column<PortMatrix>*>(_column)->swapValues(&product);
+            return true;
+        }
+        case(BO_TRANSFORM):
+        {
+            if (vectors.empty() || matrices.empty()) return false;
+            std::vector<PortVector> transformed = *vectors.at(0);
+            std::vector<PortVector> next(m_rows);
+            for (int i = 0; i < int(matrices.size()); i++)
+            {
+                VectorKernels::transform(&transformed[0],&(*matrices.at(i))[0],&next[0],m_rows);
+                transformed.swap(next);
+            }
+            static_cast<Column<PortVector>*>(_column)->swapValues(&transformed);
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+PORT_TYPE BatchEvaluator::operationType(BATCH_OPERATION _operation)
+{
+    switch (_operation)
+    {
+        case(BO_DOT): return PT_DOUBLE;
+        case(BO_MULTIPLY): return PT_MATRIX;
+        case(BO_COMBINE): return PT_ANY;
+        default: return PT_VECTOR;
+    }
+}
+
+PortBase *BatchEvaluator::valuePort(GraphNode *_node)
+{
+    if (!_node || _node->numOutboundSockets() == 0) return NULL;
+    return _node->outboundSocket(0)->port();
+}
+
+PORT_TYPE BatchEvaluator::valueType(GraphNode *_node)
+{
+    PortBase *port = valuePort(_node);
+    return port ? port->type() : PT_NONE;
+}
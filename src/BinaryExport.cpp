@@ -0,0 +1,129 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "BinaryExport.h"
+#include "NodeSocket.h"
+#include "GraphEdge.h"
+#include "Utilities.h"
+
+#include <QHash>
+
+// the format is little endian whatever the host
+static void putU16(char *_out, quint16 _value)
+{
+    _out[0] = char(_value & 0xFF);
+    _out[1] = char(_value >> 8);
+}
+
+static void putU32(char *_out, quint32 _value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        _out[i] = char((_value >> (8 * i)) & 0xFF);
+    }
+}
+
+// a string stored once in the arena
+struct ArenaString
+{
+    quint32 m_offset;
+    quint32 m_length;
+};
+
+static ArenaString addString(std::string_view _string, QByteArray *_arena, QHash<QByteArray, quint32> *_offsets)
+{
+    QByteArray bytes(_string.data(),int(_string.size()));
+    ArenaString stored;
+    stored.m_length = quint32(bytes.size());
+    QHash<QByteArray, quint32>::const_iterator found = _offsets->constFind(bytes);
+    if (found != _offsets->constEnd())
+    {
+        stored.m_offset = found.value();
+        return stored;
+    }
+    stored.m_offset = quint32(_arena->size());
+    _offsets->insert(bytes,stored.m_offset);
+    _arena->append(bytes);
+    return stored;
+}
+
+void BinaryExport::write(const std::vector<GraphNode*> &_nodes, QByteArray *_data)
+{
+    QHash<GraphNode*, quint32> indices;
+    for (int i = 0; i < int(_nodes.size()); i++)
+    {
+        indices.insert(_nodes.at(i),quint32(i));
+    }
+
+    QByteArray nodeTable(int(_nodes.size()) * BINARY_EXPORT_NODE_SIZE,'\0');
+    QByteArray edgeTable;
+    QByteArray arena;
+    QHash<QByteArray, quint32> offsets;
+    for (int i = 0; i < int(_nodes.size()); i++)
+    {
+        GraphNode *node = _nodes.at(i);
+        char *out = nodeTable.data() + i * BINARY_EXPORT_NODE_SIZE;
+        putU32(out,node->id());
+        out[4] = char(node->valueType());
+        out[5] = char(node->endNode() ? BINARY_EXPORT_FLAG_END : 0);
+        putU16(out + 6,quint16(node->nodeType()));
+
+        ArenaString strings[4] = {addString(GenUtils::valueTypeToString(node->valueType()),&arena,&offsets),
+                                  addString(GenUtils::nodeTypeToString(node->nodeType()),&arena,&offsets),
+                                  addString(node->name(),&arena,&offsets),
+                                  addString(node->shortName(),&arena,&offsets)};
+        for (int s = 0; s < 4; s++)
+        {
+            putU32(out + 8 + s * 8,strings[s].m_offset);
+            putU32(out + 12 + s * 8,strings[s].m_length);
+        }
+
+        // walking inbound sockets keeps each nodes edges in socket then creation order
+        for (int s = 0; s < node->numInboundSockets(); s++)
+        {
+            NodeSocket *socket = node->inboundSocket(s);
+            for (int e = 0; e < socket->numEdges(); e++)
+            {
+                GraphEdge *edge = socket->edge(e);
+                QHash<GraphNode*, quint32>::const_iterator source = indices.constFind(edge->sourceNode());
+                if (source == indices.constEnd()) continue;
+
+                char record[BINARY_EXPORT_EDGE_SIZE];
+                putU32(record,source.value());
+                putU32(record + 4,quint32(i));
+                putU16(record + 8,quint16(edge->sourceNode()->outboundSocketIndex(edge->sourceSocket())));
+                putU16(record + 10,quint16(s));
+                edgeTable.append(record,BINARY_EXPORT_EDGE_SIZE);
+            }
+        }
+    }
+
+    char header[BINARY_EXPORT_HEADER_SIZE];
+    putU32(header,BINARY_EXPORT_MAGIC);
+    putU16(header + 4,BINARY_EXPORT_VERSION);
+    putU16(header + 6,0);
+    putU32(header + 8,quint32(_nodes.size()));
+    putU32(header + 12,quint32(edgeTable.size() / BINARY_EXPORT_EDGE_SIZE));
+    putU32(header + 16,quint32(arena.size()));
+
+    _data->clear();
+    _data->reserve(BINARY_EXPORT_HEADER_SIZE + nodeTable.size() + edgeTable.size() + arena.size());
+    _data->append(header,BINARY_EXPORT_HEADER_SIZE);
+    _data->append(nodeTable);
+    _data->append(edgeTable);
+    _data->append(arena);
+}
@@ -0,0 +1,195 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "CacheBudget.h"
+
+#include <QPixmapCache>
+#include <QTimer>
+
+#ifdef DEBUG
+    #include <iostream>
+#endif
+
+// items smaller than this many pixels on screen are cheaper to paint than to cache
+#define MIN_CACHE_AREA 1024.0
+// past this zoom the item is cached at a fixed resolution instead of growing its pixmap with the zoom
+#define ITEM_CACHE_MAX_SCALE 2.0
+#define BYTES_PER_PIXEL 4
+
+CacheBudget::CacheBudget(QGraphicsView *_view, QObject *_parent) : QObject(_parent)
+{
+    m_view = _view;
+    m_budget = 0;
+    m_usage = 0;
+    m_scheduled = false;
+}
+
+CacheBudget::~CacheBudget()
+{
+    // the items belong to the scene, only the book keeping is cleared here
+    m_entries.clear();
+    m_recent.clear();
+    m_pending.clear();
+}
+
+void CacheBudget::setBudget(qint64 _bytes)
+{
+    m_budget = _bytes;
+
+    // item caches are stored in the global pixmap cache, so its limit has to cover the budget or
+    // Qt will start dropping pixmaps on its own
+    int limitKb = int(_bytes / 1024);
+    if (QPixmapCache::cacheLimit() < limitKb)
+    {
+        QPixmapCache::setCacheLimit(limitKb);
+    }
+
+    enforce();
+}
+
+void CacheBudget::touch(QGraphicsItem *_item)
+{
+    if (!m_entries.contains(_item))
+    {
+        Entry entry;
+        entry.m_recent = m_recent.end();
+        entry.m_bytes = 0;
+        entry.m_cached = false;
+        m_entries.insert(_item,entry);
+    }
+    m_pending.insert(_item);
+
+    if (!m_scheduled)
+    {
+        m_scheduled = true;
+        QTimer::singleShot(0,this,SLOT(enforce()));
+    }
+}
+
+void CacheBudget::release(QGraphicsItem *_item)
+{
+    QHash<QGraphicsItem*, Entry>::iterator found = m_entries.find(_item);
+    if (found == m_entries.end()) return;
+
+    evict(_item,found.value());
+    m_entries.erase(found);
+    m_pending.remove(_item);
+}
+
+void CacheBudget::enforce()
+{
+    m_scheduled = false;
+
+    for (QSet<QGraphicsItem*>::const_iterator it = m_pending.constBegin(); it != m_pending.constEnd(); ++it)
+    {
+        QHash<QGraphicsItem*, Entry>::iterator found = m_entries.find(*it);
+        if (found != m_entries.end())
+        {
+            applyMode(*it,found.value());
+        }
+    }
+    m_pending.clear();
+
+    // the items seen longest ago are at the back of the list
+    while (m_usage > m_budget && !m_recent.empty())
+    {
+        QGraphicsItem *oldest = m_recent.back();
+        evict(oldest,m_entries[oldest]);
+    }
+
+#ifdef DEBUG
+    std::cout<<"Item cache usage "<<m_usage<<" of "<<m_budget<<" bytes"<<std::endl;
+#endif
+}
+
+void CacheBudget::applyMode(QGraphicsItem *_item, Entry &_entry)
+{
+    QRectF local = _item->boundingRect();
+    QRectF device = m_view->viewportTransform().mapRect(_item->sceneBoundingRect());
+    QRectF viewport(m_view->viewport()->rect());
+
+    QGraphicsItem::CacheMode mode = QGraphicsItem::DeviceCoordinateCache;
+    QSize logicalSize;
+    qreal area = device.width() * device.height();
+
+    if (area < MIN_CACHE_AREA)
+    {
+        mode = QGraphicsItem::NoCache;
+    }
+    else if (device.width() > local.width() * ITEM_CACHE_MAX_SCALE)
+    {
+        // zoomed in far enough that the device pixmap would keep growing, cache at a fixed resolution instead
+        mode = QGraphicsItem::ItemCoordinateCache;
+        logicalSize = QSize(int(local.width() * ITEM_CACHE_MAX_SCALE),int(local.height() * ITEM_CACHE_MAX_SCALE));
+        area = qreal(logicalSize.width()) * qreal(logicalSize.height());
+    }
+    else
+    {
+        // a device cache never holds more than the viewport
+        QRectF clipped = device.intersected(viewport);
+        area = qMin(area,viewport.width() * viewport.height());
+        // a cache only just turned on is counted at the size it will have once painted
+        if (clipped.isEmpty() && _item->cacheMode() == mode && _entry.m_bytes > 0)
+        {
+            // off screen but still near the view, keep whatever pixmap it has until it ages out
+            area = qreal(_entry.m_bytes / BYTES_PER_PIXEL);
+        }
+    }
+
+    if (mode == QGraphicsItem::NoCache)
+    {
+        evict(_item,_entry);
+        return;
+    }
+
+    // setting the mode again throws the pixmap away, so only a new mode or size does
+    if (_item->cacheMode() != mode || _entry.m_logicalSize != logicalSize)
+    {
+        _item->setCacheMode(mode,logicalSize);
+        _entry.m_logicalSize = logicalSize;
+    }
+
+    m_usage -= _entry.m_bytes;
+    _entry.m_bytes = qint64(area) * BYTES_PER_PIXEL;
+    m_usage += _entry.m_bytes;
+
+    // move to the front of the recency list
+    if (_entry.m_cached)
+    {
+        m_recent.erase(_entry.m_recent);
+    }
+    m_recent.push_front(_item);
+    _entry.m_recent = m_recent.begin();
+    _entry.m_cached = true;
+}
+
+void CacheBudget::evict(QGraphicsItem *_item, Entry &_entry)
+{
+    if (_item->cacheMode() != QGraphicsItem::NoCache)
+    {
+        _item->setCacheMode(QGraphicsItem::NoCache);
+    }
+    if (_entry.m_cached)
+    {
+        m_recent.erase(_entry.m_recent);
+        _entry.m_recent = m_recent.end();
+        _entry.m_cached = false;
+    }
+    m_usage -= _entry.m_bytes;
+    _entry.m_bytes = 0;
+    _entry.m_logicalSize = QSize();
+}
@@ -0,0 +1,186 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ChangeStream.h"
+
+#include <QTimer>
+
+ChangeStream::ChangeStream(QObject *_parent) : QObject(_parent)
+{
+    m_scheduled = false;
+}
+
+int ChangeStream::push(const GraphChange &_change)
+{
+    m_pending.push_back(_change);
+    m_live.push_back(true);
+    if (!m_scheduled)
+    {
+        m_scheduled = true;
+        QTimer::singleShot(0,this,SLOT(flush()));
+    }
+    return int(m_pending.size()) - 1;
+}
+
+void ChangeStream::drop(QHash<quint32, int> *_index, quint32 _id)
+{
+    QHash<quint32, int>::iterator found = _index->find(_id);
+    if (found == _index->end()) return;
+    m_live.at(found.value()) = false;
+    _index->erase(found);
+}
+
+ChangeStream::EdgeKey ChangeStream::edgeKey(const JournalEdge &_edge)
+{
+    return EdgeKey((quint64(_edge.m_sourceNode) << 32) | _edge.m_destinationNode,
+                   (quint32(_edge.m_sourceSocket) << 16) | _edge.m_destinationSocket);
+}
+
+void ChangeStream::nodeAdded(GraphNode *_node)
+{
+    GraphChange change;
+    change.m_type = CT_NODE_ADDED;
+    change.m_node = _node->id();
+    change.m_valueType = _node->valueType();
+    change.m_nodeType = _node->nodeType();
+    change.m_point = _node->getPoint();
+    change.m_name = _node->name();
+    change.m_shortName = _node->shortName();
+    m_added.insert(change.m_node,push(change));
+    m_positions.insert(change.m_node,change.m_point);
+}
+
+void ChangeStream::nodeRemoved(quint32 _id)
+{
+    m_positions.remove(_id);
+    drop(&m_moved,_id);
+    drop(&m_renamed,_id);
+    if (m_added.contains(_id))
+    {
+        // the consumer never heard of the node so it does not need to hear it went
+        drop(&m_added,_id);
+        return;
+    }
+
+    GraphChange change;
+    change.m_type = CT_NODE_REMOVED;
+    change.m_node = _id;
+    push(change);
+}
+
+void ChangeStream::nodeRenamed(GraphNode *_node)
+{
+    quint32 id = _node->id();
+    QHash<quint32, int>::const_iterator added = m_added.constFind(id);
+    if (added != m_added.constEnd())
+    {
+        m_pending.at(added.value()).m_name = _node->name();
+        m_pending.at(added.value()).m_shortName = _node->shortName();
+        return;
+    }
+    QHash<quint32, int>::const_iterator renamed = m_renamed.constFind(id);
+    if (renamed != m_renamed.constEnd())
+    {
+        m_pending.at(renamed.value()).m_name = _node->name();
+        m_pending.at(renamed.value()).m_shortName = _node->shortName();
+        return;
+    }
+
+    GraphChange change;
+    change.m_type = CT_NODE_RENAMED;
+    change.m_node = id;
+    change.m_name = _node->name();
+    change.m_shortName = _node->shortName();
+    m_renamed.insert(id,push(change));
+}
+
+void ChangeStream::nodeMoved(GraphNode *_node)
+{
+    quint32 id = _node->id();
+    QHash<quint32, QPointF>::iterator position = m_positions.find(id);
+    if (position == m_positions.end() || position.value() == _node->getPoint()) return;
+    position.value() = _node->getPoint();
+
+    QHash<quint32, int>::const_iterator added = m_added.constFind(id);
+    if (added != m_added.constEnd())
+    {
+        m_pending.at(added.value()).m_point = _node->getPoint();
+        return;
+    }
+    QHash<quint32, int>::const_iterator moved = m_moved.constFind(id);
+    if (moved != m_moved.constEnd())
+    {
+        m_pending.at(moved.value()).m_point = _node->getPoint();
+        return;
+    }
+
+    GraphChange change;
+    change.m_type = CT_NODE_MOVED;
+    change.m_node = id;
+    change.m_point = _node->getPoint();
+    m_moved.insert(id,push(change));
+}
+
+void ChangeStream::edgeConnected(const JournalEdge &_edge)
+{
+    GraphChange change;
+    change.m_type = CT_EDGE_CONNECTED;
+    change.m_edge = _edge;
+    m_connected.insert(edgeKey(_edge),push(change));
+}
+
+void ChangeStream::edgeDisconnected(const JournalEdge &_edge)
+{
+    QHash<EdgeKey, int>::iterator connected = m_connected.find(edgeKey(_edge));
+    if (connected != m_connected.end())
+    {
+        m_live.at(connected.value()) = false;
+        m_connected.erase(connected);
+        return;
+    }
+
+    GraphChange change;
+    change.m_type = CT_EDGE_DISCONNECTED;
+    change.m_edge = _edge;
+    push(change);
+}
+
+void ChangeStream::flush()
+{
+    m_scheduled = false;
+
+    std::vector<GraphChange> changes;
+    changes.reserve(m_pending.size());
+    for (int i = 0; i < int(m_pending.size()); i++)
+    {
+        if (m_live.at(i))
+        {
+            changes.push_back(m_pending.at(i));
+        }
+    }
+    m_pending.clear();
+    m_live.clear();
+    m_added.clear();
+    m_moved.clear();
+    m_renamed.clear();
+    m_connected.clear();
+
+    if (!changes.empty())
+    {
+        emit changed(changes);
+    }
+}
@@ -0,0 +1,71 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ConnectionRules.h"
+
+#define NUM_VALUE_TYPES (VT_END + 1)
+
+// mask holding every node type from _first to _last inclusive
+#define NT_RANGE(_first,_last) (((Q_UINT64_C(1) << ((_last) - (_first) + 1)) - 1) << (_first))
+
+// the types offered for each kind of node in the creation menus
+#define ARGUMENT_TYPES NT_RANGE(NT_STRING,NT_CHAR)
+#define OBJECT_TYPES NT_RANGE(NT_OBJ_ANGLE,NT_OBJ_NUM_LAST)
+#define MEMBER_TYPES NT_RANGE(NT_STRING,NT_MATRIX)
+
+// every NODE_TYPE fits in a 64 bit mask, node types a source may have, indexed by destination value type then source value type
+static const quint64 s_rules[NUM_VALUE_TYPES][NUM_VALUE_TYPES] =
+{
+    //                 VT_NOTYPE    VT_OBJECT       VT_ARGUMENTS        VT_MEMBER   VT_END
+    /* VT_NOTYPE */    {0,          0,              0,                  0,          0},
+    /* VT_OBJECT */    {0,          OBJECT_TYPES,   ARGUMENT_TYPES,     0,          0},
+    /* VT_ARGUMENTS */ {0,          0,              0,                  0,          0},
+    /* VT_MEMBER */    {0,          0,              0,                  0,          0},
+    /* VT_END */       {0,          OBJECT_TYPES,   ARGUMENT_TYPES,     0,          0}
+};
+
+// node types offered for each value type
+static const quint64 s_offered[NUM_VALUE_TYPES] = {0, OBJECT_TYPES, ARGUMENT_TYPES, MEMBER_TYPES, 0};
+
+namespace ConnectionRules
+{
+
+bool compatible(VALUE_TYPE _sourceValue, NODE_TYPE _sourceType, VALUE_TYPE _destinationValue)
+{
+    if (_sourceValue < 0 || _sourceValue >= NUM_VALUE_TYPES) return false;
+    if (_destinationValue < 0 || _destinationValue >= NUM_VALUE_TYPES) return false;
+    if (_sourceType < 0 || _sourceType >= 64) return false;
+
+    return (s_rules[_destinationValue][_sourceValue] & (Q_UINT64_C(1) << _sourceType)) != 0;
+}
+
+bool compatible(GraphNode *_source, GraphNode *_destination)
+{
+    if (!_source || !_destination) return false;
+
+    return compatible(_source->valueType(),_source->nodeType(),_destination->valueType());
+}
+
+bool offered(VALUE_TYPE _value, NODE_TYPE _type)
+{
+    if (_value < 0 || _value >= NUM_VALUE_TYPES) return false;
+    if (_type < 0 || _type >= 64) return false;
+
+    return (s_offered[_value] & (Q_UINT64_C(1) << _type)) != 0;
+}
+
+}
@@ -0,0 +1,128 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "DataflowEngine.h"
+#include "NodeSocket.h"
+#include "GraphEdge.h"
+
+#include <QSet>
+
+namespace
+{
+    // where a depth first walk through inbound sockets has got to on a node
+    struct Frame
+    {
+        GraphNode *m_node;
+        int m_socket;
+        int m_edge;
+    };
+}
+
+DataflowEngine::DataflowEngine()
+{
+    m_scheduler = NULL;
+    m_recomputed = 0;
+    m_reused = 0;
+}
+
+void DataflowEngine::nodeChanged(GraphNode *_node)
+{
+    if (_node)
+    {
+        m_program.markDirty(_node);
+    }
+}
+
+void DataflowEngine::edgeChanged(GraphEdge *_edge)
+{
+    // an edge into a node the program does not hold can not change its result
+    if (_edge && _edge->destinationNode() && m_program.contains(_edge->destinationNode()))
+    {
+        m_program.reshape(_edge->destinationNode());
+    }
+}
+
+void DataflowEngine::forget(GraphNode *_node)
+{
+    if (m_program.contains(_node))
+    {
+        m_program.remove(_node);
+    }
+}
+
+const NodeResult &DataflowEngine::evaluate(GraphNode *_node)
+{
+    if (m_program.root() != _node || m_program.stale())
+    {
+        m_program.compile(_node);
+    }
+    int executed = m_program.run(m_scheduler);
+    m_recomputed += executed;
+    m_reused += m_program.size() - executed;
+    return m_program.result();
+}
+
+void DataflowEngine::upstreamOrder(GraphNode *_node, std::vector<GraphNode*> *_order)
+{
+    QSet<GraphNode*> visited;
+    visited.insert(_node);
+    std::vector<Frame> stack;
+    Frame first = {_node, 0, 0};
+    stack.push_back(first);
+
+    while (!stack.empty())
+    {
+        Frame &top = stack.back();
+        GraphNode *next = NULL;
+
+        // find the next unvisited node feeding the top of the stack
+        while (!next && top.m_socket < top.m_node->numInboundSockets())
+        {
+            NodeSocket *socket = top.m_node->inboundSocket(top.m_socket);
+            if (top.m_edge < socket->numEdges())
+            {
+                GraphNode *source = socket->edge(top.m_edge)->sourceNode();
+                top.m_edge++;
+                if (!visited.contains(source))
+                {
+                    visited.insert(source);
+                    next = source;
+                }
+            }
+            else
+            {
+                top.m_socket++;
+                top.m_edge = 0;
+            }
+        }
+
+        if (next)
+        {
+            Frame frame = {next, 0, 0};
+            stack.push_back(frame);
+        }
+        else
+        {
+            // everything feeding this node has been emitted so it can follow
+            if (top.m_node != _node)
+            {
+                _order->push_back(top.m_node);
+            }
+            stack.pop_back();
+        }
+    }
+}
@@ -0,0 +1,480 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "DeltaExport.h"
+#include "DataflowEngine.h"
+#include "GraphScene.h"
+#include "Utilities.h"
+
+#include <algorithm>
+#include <sstream>
+
+#define DELTA_MARKER "#D#;"
+
+// an edge as it appears in the delta, source then destination
+static void writeEdge(std::ostringstream &_out, const char *_kind, const JournalEdge &_edge)
+{
+    _out<<_kind<<";"<<_edge.m_sourceNode<<";"<<_edge.m_sourceSocket<<";"
+        <<_edge.m_destinationNode<<";"<<_edge.m_destinationSocket<<";";
+}
+
+std::string ExportDelta::toString() const
+{
+    std::ostringstream out;
+    out<<DELTA_MARKER<<m_baseRevision<<";"<<m_revision<<";";
+    for (int i = 0; i < int(m_removed.size()); i++)
+    {
+        out<<"-;"<<m_removed.at(i)<<";";
+    }
+    for (int i = 0; i < int(m_added.size()); i++)
+    {
+        out<<"+;"<<m_added.at(i).m_id<<";"<<m_added.at(i).m_position<<";"<<m_added.at(i).m_record;
+    }
+    for (int i = 0; i < int(m_modified.size()); i++)
+    {
+        out<<"*;"<<m_modified.at(i).m_id<<";"<<m_modified.at(i).m_position<<";"<<m_modified.at(i).m_record;
+    }
+    for (int i = 0; i < int(m_moved.size()); i++)
+    {
+        out<<">;"<<m_moved.at(i).m_id<<";"<<m_moved.at(i).m_position<<";";
+    }
+    for (int i = 0; i < int(m_connected.size()); i++)
+    {
+        writeEdge(out,"=",m_connected.at(i));
+    }
+    for (int i = 0; i < int(m_disconnected.size()); i++)
+    {
+        writeEdge(out,"!",m_disconnected.at(i));
+    }
+    out<<DELTA_MARKER;
+    return out.str();
+}
+
+DeltaExport::DeltaExport(GraphScene *_scene, ChangeStream *_changes)
+{
+    m_scene = _scene;
+    m_changes = _changes;
+    m_end = 0;
+    m_revision = 0;
+    m_valid = true;
+    m_memberCount = 0;
+    m_repeated = 0;
+    m_membersChanged = true;
+    m_upstreamChanged = true;
+    connect(m_changes,SIGNAL(changed(std::vector<GraphChange>)),this,SLOT(apply(std::vector<GraphChange>)));
+}
+
+bool DeltaExport::complete(GraphNode *_node)
+{
+    // member nodes are exported as they are, as in GraphScene::collectInformation
+    if (_node->valueType() == VT_MEMBER) return true;
+    return GenUtils::nodeTypeToString(_node->nodeType()) != "" && _node->name() != "" && _node->shortName() != "";
+}
+
+void DeltaExport::countTokens(QHash<QByteArray, int> *_counts, int *_repeated, const std::string &_record,
+                              bool _member, int _step)
+{
+    // member records are one token, the others a token per field with the value type left out as
+    // GenUtils::tokensUnique skips whatever follows a --
+    std::vector<QByteArray> tokens;
+    if (_member)
+    {
+        tokens.push_back(QByteArray(_record.data(),int(_record.size())));
+    }
+    else
+    {
+        size_t from = _record.find(';');
+        bool skip = false;
+        while (from != std::string::npos && from + 1 < _record.size())
+        {
+            size_t to = _record.find(';',from + 1);
+            if (to == std::string::npos) break;
+            QByteArray token(_record.data() + from + 1,int(to - from));
+            if (token == "--;")
+            {
+                skip = true;
+            }
+            else if (skip)
+            {
+                skip = false;
+            }
+            else
+            {
+                tokens.push_back(token);
+            }
+            from = to;
+        }
+    }
+    for (int i = 0; i < int(tokens.size()); i++)
+    {
+        int &count = (*_counts)[tokens.at(i)];
+        count += _step;
+        if (_step > 0 && count == 2) (*_repeated)++;
+        if (_step < 0 && count == 1) (*_repeated)--;
+        if (count == 0) _counts->remove(tokens.at(i));
+    }
+}
+
+void DeltaExport::walk(GraphNode *_end, std::vector<quint32> *_order, std::vector<JournalEdge> *_edges)
+{
+    std::vector<GraphNode*> nodes;
+    DataflowEngine::upstreamOrder(_end,&nodes);
+    for (int i = 0; i < int(nodes.size()); i++)
+    {
+        _order->push_back(nodes.at(i)->id());
+    }
+
+    nodes.push_back(_end);
+    for (int i = 0; i < int(nodes.size()); i++)
+    {
+        GraphNode *node = nodes.at(i);
+        for (int s = 0; s < node->numInboundSockets(); s++)
+        {
+            NodeSocket *socket = node->inboundSocket(s);
+            for (int e = 0; e < socket->numEdges(); e++)
+            {
+                NodeSocket *source = socket->edge(e)->sourceSocket();
+                JournalEdge edge;
+                edge.m_sourceNode = source->getParentNode()->id();
+                edge.m_destinationNode = node->id();
+                edge.m_sourceSocket = quint16(source->getParentNode()->outboundSocketIndex(source));
+                edge.m_destinationSocket = quint16(s);
+                _edges->push_back(edge);
+            }
+        }
+    }
+}
+
+void DeltaExport::apply(const std::vector<GraphChange> &_changes)
+{
+    for (int i = 0; i < int(_changes.size()); i++)
+    {
+        const GraphChange &change = _changes.at(i);
+        switch (change.m_type)
+        {
+            case(CT_NODE_ADDED):
+                // a new node has no edges yet, only the end node and member nodes change the export
+                if (change.m_valueType == VT_END)
+                {
+                    m_end = change.m_node;
+                    m_upstreamChanged = true;
+                }
+                else if (change.m_valueType == VT_MEMBER)
+                {
+                    m_members.push_back(change.m_node);
+                    m_membersChanged = true;
+                }
+                break;
+            case(CT_NODE_REMOVED):
+            {
+                if (change.m_node == m_end)
+                {
+                    m_end = 0;
+                    m_upstreamChanged = true;
+                }
+                else if (m_upstream.contains(change.m_node))
+                {
+                    m_upstreamChanged = true;
+                }
+                std::vector<quint32>::iterator member = std::find(m_members.begin(),m_members.end(),change.m_node);
+                if (member != m_members.end())
+                {
+                    m_members.erase(member);
+                    m_membersChanged = true;
+                }
+                break;
+            }
+            case(CT_NODE_RENAMED):
+                m_touched.insert(change.m_node);
+                break;
+            case(CT_EDGE_CONNECTED):
+            case(CT_EDGE_DISCONNECTED):
+                // edges between nodes that are not exported change nothing until they are joined to one that is
+                if (exportsInto(change.m_edge))
+                {
+                    m_upstreamChanged = true;
+                }
+                break;
+            default:
+                // where a node sits in the scene is not part of the export
+                break;
+        }
+    }
+}
+
+bool DeltaExport::collect(quint64 _sinceRevision, ExportDelta *_delta)
+{
+    // every change made so far has to have reached apply
+    m_changes->flush();
+
+    GraphNode *end = m_end ? m_scene->nodeById(m_end) : NULL;
+    if (!end) return false;
+
+    bool full = _sinceRevision == 0 || _sinceRevision != m_revision;
+    std::vector<DeltaRecord> added;
+    std::vector<DeltaRecord> modified;
+    std::vector<DeltaRecord> moved;
+    std::vector<quint32> removed;
+    std::vector<JournalEdge> connected;
+    std::vector<JournalEdge> disconnected;
+
+    if (!full && !m_membersChanged && !m_upstreamChanged && m_touched.isEmpty())
+    {
+        _delta->m_baseRevision = _sinceRevision;
+        _delta->m_revision = m_revision;
+        _delta->m_added.swap(added);
+        _delta->m_modified.swap(modified);
+        _delta->m_moved.swap(moved);
+        _delta->m_removed.swap(removed);
+        _delta->m_connected.swap(connected);
+        _delta->m_disconnected.swap(disconnected);
+        return true;
+    }
+
+    // only edges into exported nodes walk the graph again
+    std::vector<quint32> upstreamOrder;
+    std::vector<JournalEdge> walked;
+    if (m_upstreamChanged)
+    {
+        walk(end,&upstreamOrder,&walked);
+    }
+    else
+    {
+        upstreamOrder = m_upstreamOrder;
+        walked = m_edges;
+    }
+
+    // member nodes then everything upstream of the end node, as in GraphScene::exportedNodes
+    std::vector<quint32> order = m_members;
+    QSet<quint32> members;
+    members.reserve(int(m_members.size()));
+    for (int i = 0; i < int(m_members.size()); i++) members.insert(m_members.at(i));
+
+    // as in GraphScene::collectInformation, one incomplete node leaves out everything upstream of the end node,
+    // nodes already exported and not renamed since are known to be complete
+    bool valid = true;
+    for (int i = 0; valid && i < int(upstreamOrder.size()); i++)
+    {
+        quint32 id = upstreamOrder.at(i);
+        if (members.contains(id) || (m_records.contains(id) && !m_touched.contains(id))) continue;
+        GraphNode *node = m_scene->nodeById(id);
+        valid = node && complete(node);
+    }
+    if (valid)
+    {
+        for (int i = 0; i < int(upstreamOrder.size()); i++)
+        {
+            if (!members.contains(upstreamOrder.at(i)))
+            {
+                order.push_back(upstreamOrder.at(i));
+            }
+        }
+    }
+
+    // only nodes new to the export or renamed since the last one are recorded
+    QHash<quint32, int> positions;
+    positions.reserve(int(order.size()));
+    for (int i = 0; i < int(order.size()); i++)
+    {
+        quint32 id = order.at(i);
+        positions.insert(id,i);
+        QHash<quint32, std::string>::const_iterator found = m_records.constFind(id);
+        bool known = found != m_records.constEnd();
+        if (!known || m_touched.contains(id))
+        {
+            GraphNode *node = m_scene->nodeById(id);
+            if (!node) return false;
+
+            DeltaRecord record;
+            record.m_id = id;
+            record.m_position = i;
+            record.m_record = node->getNodeInfo();
+            if (!known || full)
+            {
+                added.push_back(record);
+                continue;
+            }
+            if (record.m_record != found.value())
+            {
+                modified.push_back(record);
+                continue;
+            }
+        }
+        if (full)
+        {
+            DeltaRecord record;
+            record.m_id = id;
+            record.m_position = i;
+            record.m_record = found.value();
+            added.push_back(record);
+        }
+        else if (m_positions.value(id,-1) != i)
+        {
+            DeltaRecord record;
+            record.m_id = id;
+            record.m_position = i;
+            moved.push_back(record);
+        }
+    }
+    if (!full)
+    {
+        for (int i = 0; i < int(m_order.size()); i++)
+        {
+            if (!positions.contains(m_order.at(i)))
+            {
+                removed.push_back(m_order.at(i));
+            }
+        }
+    }
+
+    // the same rule as GraphScene::collectInformation, only the records that changed move the token counts
+    int numMembers = int(m_members.size());
+    QHash<QByteArray, int> counts;
+    int repeated = 0;
+    if (full)
+    {
+        counts.reserve(numMembers + (int(order.size()) - numMembers) * 3);
+        for (int i = 0; i < int(added.size()); i++)
+        {
+            countTokens(&counts,&repeated,added.at(i).m_record,added.at(i).m_position < numMembers,1);
+        }
+    }
+    else
+    {
+        counts.swap(m_tokenCounts);
+        repeated = m_repeated;
+        for (int i = 0; i < int(removed.size()); i++)
+        {
+            countTokens(&counts,&repeated,m_records.value(removed.at(i)),
+                        m_positions.value(removed.at(i)) < m_memberCount,-1);
+        }
+        for (int i = 0; i < int(modified.size()); i++)
+        {
+            bool member = modified.at(i).m_position < numMembers;
+            countTokens(&counts,&repeated,m_records.value(modified.at(i).m_id),member,-1);
+            countTokens(&counts,&repeated,modified.at(i).m_record,member,1);
+        }
+        for (int i = 0; i < int(added.size()); i++)
+        {
+            countTokens(&counts,&repeated,added.at(i).m_record,added.at(i).m_position < numMembers,1);
+        }
+    }
+    bool unique = repeated == 0;
+    if (unique && int(order.size()) > numMembers)
+    {
+        // the value type of the first node upstream is the one not following a --
+        quint32 first = order.at(numMembers);
+        std::string record = m_records.value(first);
+        for (int i = 0; i < int(added.size()); i++)
+        {
+            if (added.at(i).m_id == first) record = added.at(i).m_record;
+        }
+        for (int i = 0; i < int(modified.size()); i++)
+        {
+            if (modified.at(i).m_id == first) record = modified.at(i).m_record;
+        }
+        unique = !counts.contains(QByteArray(record.data(),int(record.find(';') + 1)));
+    }
+    if (!unique)
+    {
+        if (!full)
+        {
+            // put the counts of the last export back
+            for (int i = 0; i < int(added.size()); i++)
+            {
+                countTokens(&counts,&repeated,added.at(i).m_record,added.at(i).m_position < numMembers,-1);
+            }
+            for (int i = 0; i < int(modified.size()); i++)
+            {
+                bool member = modified.at(i).m_position < numMembers;
+                countTokens(&counts,&repeated,modified.at(i).m_record,member,-1);
+                countTokens(&counts,&repeated,m_records.value(modified.at(i).m_id),member,1);
+            }
+            for (int i = 0; i < int(removed.size()); i++)
+            {
+                countTokens(&counts,&repeated,m_records.value(removed.at(i)),
+                            m_positions.value(removed.at(i)) < m_memberCount,1);
+            }
+            counts.swap(m_tokenCounts);
+        }
+        return false;
+    }
+
+    // everything checks out, work out which edges the export gained and lost
+    std::vector<JournalEdge> edges;
+    if (valid) edges = walked;
+    if (full)
+    {
+        connected = edges;
+    }
+    else if (m_upstreamChanged || valid != m_valid)
+    {
+        std::vector<JournalEdge> previous;
+        if (m_valid) previous = m_edges;
+        QSet<ChangeStream::EdgeKey> before;
+        QSet<ChangeStream::EdgeKey> after;
+        for (int i = 0; i < int(previous.size()); i++) before.insert(ChangeStream::edgeKey(previous.at(i)));
+        for (int i = 0; i < int(edges.size()); i++) after.insert(ChangeStream::edgeKey(edges.at(i)));
+        for (int i = 0; i < int(previous.size()); i++)
+        {
+            if (!after.contains(ChangeStream::edgeKey(previous.at(i)))) disconnected.push_back(previous.at(i));
+        }
+        for (int i = 0; i < int(edges.size()); i++)
+        {
+            if (!before.contains(ChangeStream::edgeKey(edges.at(i)))) connected.push_back(edges.at(i));
+        }
+    }
+
+    if (full) m_records.clear();
+    for (int i = 0; i < int(removed.size()); i++) m_records.remove(removed.at(i));
+    for (int i = 0; i < int(added.size()); i++) m_records.insert(added.at(i).m_id,added.at(i).m_record);
+    for (int i = 0; i < int(modified.size()); i++) m_records.insert(modified.at(i).m_id,modified.at(i).m_record);
+    if (m_upstreamChanged)
+    {
+        m_upstream.clear();
+        m_upstream.reserve(int(upstreamOrder.size()));
+        for (int i = 0; i < int(upstreamOrder.size()); i++) m_upstream.insert(upstreamOrder.at(i));
+        m_upstreamOrder.swap(upstreamOrder);
+        m_edges.swap(walked);
+    }
+    m_valid = valid;
+    m_order.swap(order);
+    m_positions.swap(positions);
+    m_memberCount = numMembers;
+    m_tokenCounts.swap(counts);
+    m_repeated = repeated;
+
+    // a reorder moves the revision on as well, so a consumer can always rebuild the export from its deltas
+    if (full || !added.empty() || !modified.empty() || !moved.empty() || !removed.empty() ||
+        !connected.empty() || !disconnected.empty())
+    {
+        m_revision++;
+    }
+    m_touched.clear();
+    m_membersChanged = false;
+    m_upstreamChanged = false;
+
+    _delta->m_baseRevision = full ? 0 : _sinceRevision;
+    _delta->m_revision = m_revision;
+    _delta->m_added.swap(added);
+    _delta->m_modified.swap(modified);
+    _delta->m_moved.swap(moved);
+    _delta->m_removed.swap(removed);
+    _delta->m_connected.swap(connected);
+    _delta->m_disconnected.swap(disconnected);
+    return true;
+}
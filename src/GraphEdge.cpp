@@ -16,8 +16,11 @@
 */
 
 #include "GraphEdge.h"
+#include "GraphScene.h"
 
 #include <QPainter>
+#include <QPainterPathStroker>
+#include <QStyleOptionGraphicsItem>
 
 #include <iostream>
 
@@ -63,6 +66,9 @@ GraphEdge::~GraphEdge()
 void GraphEdge::init()
 {
     m_arrowSize = DEFAULT_ARROW_SIZE;
+
+    // needed so paint is given the real exposed area to cull against
+    setFlag(ItemUsesExtendedStyleOption);
 }
 
 void GraphEdge::updateEdge() // update the line start and end positions if the nodes have now moved
@@ -77,6 +83,11 @@ void GraphEdge::updateEdge() // update the line start and end positions if the n
 
     m_sourcePoint = m_sourceSocket->centre();
     m_destinationPoint = m_destinationSocket->centre();
+
+    if (m_sourceSocket->getParentScene())
+    {
+        m_sourceSocket->getParentScene()->edgeGeometryChanged(this);
+    }
 }
 
 void GraphEdge::setSourceDestinationSockets(NodeSocket *_source, NodeSocket *_destination)
@@ -148,6 +159,57 @@ QRectF GraphEdge::boundingRect() const
             .adjusted(-compensate,-compensate,compensate,compensate);
 }
 
+QPainterPath GraphEdge::shape() const
+{
+    QPainterPath path;
+    if (!m_sourceNode || !m_destinationNode) return path;
+
+    path.moveTo(m_sourcePoint);
+    path.lineTo(m_destinationPoint);
+
+    QPainterPathStroker stroker;
+    stroker.setWidth(m_arrowSize * 2.0f);
+    return stroker.createStroke(path);
+}
+
+bool GraphEdge::intersectsRect(const QRectF &_rect) const
+{
+    if (!m_sourceNode || !m_destinationNode) return false;
+
+    // clip the line against the rectangle grown by the arrow size (Liang-Barsky)
+    QRectF rect = _rect.adjusted(-m_arrowSize,-m_arrowSize,m_arrowSize,m_arrowSize);
+    qreal dx = m_destinationPoint.x() - m_sourcePoint.x();
+    qreal dy = m_destinationPoint.y() - m_sourcePoint.y();
+    qreal p[4] = {-dx, dx, -dy, dy};
+    qreal q[4] = {m_sourcePoint.x() - rect.left(), rect.right() - m_sourcePoint.x(),
+                  m_sourcePoint.y() - rect.top(), rect.bottom() - m_sourcePoint.y()};
+    qreal t0 = 0.0;
+    qreal t1 = 1.0;
+
+    for (int i = 0; i < 4; i++)
+    {
+        if (p[i] == 0.0)
+        {
+            // parallel to this side and outside of it
+            if (q[i] < 0.0) return false;
+        }
+        else
+        {
+            qreal t = q[i] / p[i];
+            if (p[i] < 0.0)
+            {
+                t0 = qMax(t0,t);
+            }
+            else
+            {
+                t1 = qMin(t1,t);
+            }
+            if (t0 > t1) return false;
+        }
+    }
+    return true;
+}
+
 void GraphEdge::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
 {
     if (!m_sourceSocket || !m_destinationSocket)
@@ -156,6 +218,9 @@ void GraphEdge::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
         return;
     }
 
+    // the bounding rectangle of a long diagonal covers far more than the line, skip it if the line misses the exposed area
+    if (!intersectsRect(option->exposedRect)) return;
+
     QLineF line(m_sourcePoint, m_destinationPoint);
 
     // check that the line length isnt 0
@@ -0,0 +1,195 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "GraphExport.h"
+#include "ConnectionRules.h"
+#include "Port.h"
+#include "Utilities.h"
+
+#include <set>
+#include <sstream>
+
+// marks the start and end of the attributes in the export, as in GraphScene::collectInformation
+#define EXPORT_MARKER "#_#;"
+
+namespace
+{
+    // where a depth first walk through a records inbound edges has got to
+    struct RecordFrame
+    {
+        int m_node;
+        int m_input;
+    };
+}
+
+// the name a record is reported by in errors
+static std::string describe(const SubgraphNode &_node, int _index)
+{
+    std::ostringstream out;
+    out<<"node "<<_index<<" ("<<GenUtils::nodeTypeToString(_node.m_nodeType)<<" '"<<_node.m_name<<"')";
+    return out.str();
+}
+
+bool GraphExport::exportGraph(const Subgraph &_graph, std::string *_string, std::string *_error)
+{
+    return exportRecords(_graph.nodes(),_graph.edges(),_string,_error);
+}
+
+bool GraphExport::exportRecords(const std::vector<SubgraphNode> &_nodes, const std::vector<SubgraphEdge> &_edges,
+                                std::string *_string, std::string *_error, bool _strict)
+{
+
+    int end = -1;
+    for (int i = 0; i < int(_nodes.size()); i++)
+    {
+        if (_nodes.at(i).m_nodeType != NT_ENDNODE) continue;
+        if (end >= 0)
+        {
+            *_error = "more than one end node";
+            return false;
+        }
+        end = i;
+    }
+    if (end < 0)
+    {
+        *_error = "no end node";
+        return false;
+    }
+
+    // the sources feeding each node, by inbound socket then in file order, which Subgraph::capture writes in the order
+    // the scene attached them so the walk below visits inputs in the same order as the scene's export
+    int maxInbound = 0;
+    for (int i = 0; i < int(_nodes.size()); i++)
+    {
+        maxInbound = qMax(maxInbound,_nodes.at(i).m_numInbound);
+    }
+    std::vector<std::vector<int> > inputs(_nodes.size());
+    std::set<std::pair<std::pair<int, int>, std::pair<int, int> > > seen;
+    for (int socket = 0; socket < maxInbound; socket++)
+    {
+        for (int i = 0; i < int(_edges.size()); i++)
+        {
+            const SubgraphEdge &edge = _edges.at(i);
+            if (edge.m_destinationSocket != socket) continue;
+
+            const SubgraphNode &source = _nodes.at(edge.m_sourceNode);
+            const SubgraphNode &destination = _nodes.at(edge.m_destinationNode);
+            // the same checks as GraphScene::connectSockets, a port is only checked if both sockets carry one
+            PortBase sourcePort(PortTypes::forNode(source.m_nodeType),NULL);
+            PortBase destinationPort(PortTypes::forNode(destination.m_nodeType),NULL);
+            if (edge.m_sourceNode == edge.m_destinationNode ||
+                !ConnectionRules::compatible(source.m_valueType,source.m_nodeType,destination.m_valueType) ||
+                (sourcePort.type() != PT_NONE && destinationPort.type() != PT_NONE && !destinationPort.accepts(&sourcePort)))
+            {
+                *_error = "edge from "+describe(source,edge.m_sourceNode)+" to "+describe(destination,edge.m_destinationNode)+" is not allowed";
+                return false;
+            }
+            if (!seen.insert(std::make_pair(std::make_pair(edge.m_sourceNode,edge.m_sourceSocket),
+                                            std::make_pair(edge.m_destinationNode,edge.m_destinationSocket))).second)
+            {
+                *_error = "edge from "+describe(source,edge.m_sourceNode)+" to "+describe(destination,edge.m_destinationNode)+" is given twice";
+                return false;
+            }
+            inputs.at(edge.m_destinationNode).push_back(edge.m_sourceNode);
+        }
+    }
+
+    std::vector<std::string> gatherVector;
+    for (int i = 0; i < int(_nodes.size()); i++)
+    {
+        const SubgraphNode &node = _nodes.at(i);
+        if (node.m_valueType == VT_MEMBER)
+        {
+            gatherVector.push_back(std::string(GenUtils::valueTypeToString(node.m_valueType))+";"+std::string(GenUtils::nodeTypeToString(node.m_nodeType))+";"+
+                                   node.m_name+";"+node.m_shortName+";--;");
+        }
+    }
+
+    // everything upstream of the end node, each node once and after all that feed it
+    // 0 not yet seen, 1 on the walk, 2 emitted
+    int numMembers = int(gatherVector.size());
+    bool complete = true;
+    std::vector<quint8> state(_nodes.size(),0);
+    std::vector<RecordFrame> stack;
+    RecordFrame first = {end, 0};
+    stack.push_back(first);
+    state.at(end) = 1;
+    while (!stack.empty())
+    {
+        RecordFrame &top = stack.back();
+        if (top.m_input < int(inputs.at(top.m_node).size()))
+        {
+            int source = inputs.at(top.m_node).at(top.m_input++);
+            if (state.at(source) == 1)
+            {
+                *_error = "cycle through "+describe(_nodes.at(source),source);
+                return false;
+            }
+            if (state.at(source) == 0)
+            {
+                state.at(source) = 1;
+                RecordFrame frame = {source, 0};
+                stack.push_back(frame);
+            }
+            continue;
+        }
+
+        int index = top.m_node;
+        stack.pop_back();
+        state.at(index) = 2;
+        if (index == end) continue;
+
+        // the scene silently leaves out an incomplete graph, unless asked to do the same it is reported
+        const SubgraphNode &node = _nodes.at(index);
+        std::string_view type = GenUtils::nodeTypeToString(node.m_nodeType);
+        if (type == "" || node.m_name == "" || node.m_shortName == "")
+        {
+            if (_strict)
+            {
+                *_error = describe(node,index)+" is missing its type or a name";
+                return false;
+            }
+            complete = false;
+            continue;
+        }
+        gatherVector.push_back(std::string(GenUtils::valueTypeToString(node.m_valueType))+";");
+        gatherVector.push_back(std::string(type)+";");
+        gatherVector.push_back(std::string(node.m_name+";"));
+        gatherVector.push_back(std::string(node.m_shortName+";"));
+        gatherVector.push_back("--;");
+    }
+
+    if (!complete)
+    {
+        gatherVector.resize(numMembers);
+    }
+
+    if (!GenUtils::tokensUnique(gatherVector))
+    {
+        *_error = "a name is used more than once";
+        return false;
+    }
+
+    std::string returnString = EXPORT_MARKER;
+    for (int i = 0; i < int(gatherVector.size()); i++)
+    {
+        returnString += gatherVector.at(i);
+    }
+    returnString += EXPORT_MARKER;
+    *_string = returnString;
+    return true;
+}
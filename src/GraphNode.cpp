@@ -20,6 +20,7 @@
 #include "GraphEdge.h"
 #include "NodeSocket.h"
 #include "Utilities.h"
+#include "Port.h"
 
 #include <iostream>
 
@@ -35,6 +36,9 @@
 #include <QFontMetrics>
 
 #define LINE_EDGE_WIDTH 0
+// lowest z value a node can have, depths are added on top of this
+#define NODE_Z_FLOOR -4294967296.0
+#define SOCKET_Z_OFFSET 0.5
 
 GraphNode::GraphNode(VALUE_TYPE _vType, NODE_TYPE _type, QGraphicsItem *_parent) : QGraphicsItem(_parent)
 {
@@ -254,6 +258,10 @@ void GraphNode::setWidth(qreal _w)
         prepareGeometryChange();
         m_width = _w;
         calculateSocketPositions();
+        if (m_parentScene)
+        {
+            m_parentScene->nodeGeometryChanged(this);
+        }
     }
     else
     {
@@ -271,6 +279,10 @@ void GraphNode::setHeight(qreal _h)
         prepareGeometryChange();
         m_height = _h;
         calculateSocketPositions();
+        if (m_parentScene)
+        {
+            m_parentScene->nodeGeometryChanged(this);
+        }
     }
     else
     {
@@ -283,9 +295,15 @@ void GraphNode::setHeight(qreal _h)
 
 void GraphNode::setName(std::string _name)
 {
+    std::string oldName = m_name;
     m_name = _name;
-    m_nodeName->setPlainText(m_name.c_str());
-    QFontMetrics met(m_nodeName->font());
+    if (m_nodeName)
+    {
+        m_nodeName->setPlainText(m_name.c_str());
+    }
+    // labels always use the default font so the width can be measured without one
+    QFont labelFont;
+    QFontMetrics met(labelFont);
     int width = met.width(QString(_name.c_str()));
     if (width >= m_baseWidth - 20.0)
     {
@@ -296,20 +314,56 @@ void GraphNode::setName(std::string _name)
         setWidth(m_baseWidth);
     }
     update();
+
+    if (m_parentScene && oldName != m_name)
+    {
+        m_parentScene->nodeRenamed(this,oldName,m_shortName);
+    }
 }
 
 void GraphNode::setShortName(std::string _name)
 {
+    std::string oldShortName = m_shortName;
     m_shortName = _name;
-    m_nodeShortName->setPlainText(m_shortName.c_str());
+    if (m_nodeShortName)
+    {
+        m_nodeShortName->setPlainText(m_shortName.c_str());
+    }
     update();
+
+    if (m_parentScene && oldShortName != m_shortName)
+    {
+        m_parentScene->nodeRenamed(this,m_name,oldShortName);
+    }
+}
+
+int GraphNode::inboundSocketIndex(NodeSocket *_socket)
+{
+    for (int i = 0; i < m_numInboundSockets; i++)
+    {
+        if (m_inboundSockets->at(i) == _socket) return i;
+    }
+    return -1;
+}
+
+int GraphNode::outboundSocketIndex(NodeSocket *_socket)
+{
+    for (int i = 0; i < m_numOutboundSockets; i++)
+    {
+        if (m_outboundSockets->at(i) == _socket) return i;
+    }
+    return -1;
 }
 
 void GraphNode::setNodeTitle(std::string _title)
 {
     if (m_type == NT_ENDNODE)
     {
-        m_nodeTypeText->setPlainText(_title.c_str());
+        m_title = _title;
+        if (m_nodeTypeText)
+        {
+            m_nodeTypeText->setPlainText(m_title.c_str());
+        }
     }
 }
 
@@ -317,10 +371,77 @@ void GraphNode::setPoint(QPointF _point)
 {
      prepareGeometryChange();
      m_nodePoint = _point;
-     m_nodeTypeText->setPos(getPoint().x()+15.0,getPoint().y()+10.0);
-     m_nodeName->setPos(getPoint().x()+15.0,getPoint().y()+30.0);
-     m_nodeShortName->setPos(getPoint().x()+15.0,getPoint().y()+50.0);
+     positionLabels();
      calculateSocketPositions();
+     if (m_parentScene)
+     {
+         m_parentScene->nodeGeometryChanged(this);
+     }
+}
+
+void GraphNode::setZDepth(int _depth)
+{
+    m_zDepth = _depth;
+
+    // every node sits below zero so edges are still drawn over the top of them,
+    // and each socket sits just above its own node but below any node stacked over it
+    qreal z = NODE_Z_FLOOR + qreal(_depth);
+    setZValue(z);
+    for (int i = 0; i < m_numInboundSockets; i++)
+    {
+        m_inboundSockets->at(i)->setZValue(z+SOCKET_Z_OFFSET);
+    }
+    for (int i = 0; i < m_numOutboundSockets; i++)
+    {
+        m_outboundSockets->at(i)->setZValue(z+SOCKET_Z_OFFSET);
+    }
+}
+
+void GraphNode::showLabels()
+{
+    if (m_nodeTypeText || !m_parentScene) return;
+
+    // labels are the heaviest part of a node so they are borrowed from the scene only while the node is near the view
+    m_nodeTypeText = m_parentScene->takeLabel();
+    m_nodeName = m_parentScene->takeLabel();
+    m_nodeShortName = m_parentScene->takeLabel();
+
+    QFont titleFont;
+    titleFont.setBold(true);
+    m_nodeTypeText->setFont(titleFont);
+    m_nodeName->setFont(QFont());
+    m_nodeShortName->setFont(QFont());
+
+    m_nodeTypeText->setPlainText(m_title.c_str());
+    m_nodeName->setPlainText(m_name.c_str());
+    m_nodeShortName->setPlainText(m_shortName.c_str());
+
+    m_nodeTypeText->setParentItem(this);
+    m_nodeName->setParentItem(this);
+    m_nodeShortName->setParentItem(this);
+    positionLabels();
+}
+
+void GraphNode::hideLabels()
+{
+    if (!m_nodeTypeText || !m_parentScene) return;
+
+    m_parentScene->returnLabel(m_nodeTypeText);
+    m_parentScene->returnLabel(m_nodeName);
+    m_parentScene->returnLabel(m_nodeShortName);
+
+    m_nodeTypeText = NULL;
+    m_nodeName = NULL;
+    m_nodeShortName = NULL;
+}
+
+void GraphNode::positionLabels()
+{
+    if (!m_nodeTypeText) return;
+
+    m_nodeTypeText->setPos(getPoint().x()+15.0,getPoint().y()+10.0);
+    m_nodeName->setPos(getPoint().x()+15.0,getPoint().y()+30.0);
+    m_nodeShortName->setPos(getPoint().x()+15.0,getPoint().y()+50.0);
 }
 
 void GraphNode::mouseMoveEvent(QGraphicsSceneMouseEvent *_event)
@@ -360,40 +481,16 @@ void GraphNode::printNodeInfo()
 std::string GraphNode::getNodeInfo()
 {
     std::string returnString = "";
-    returnString += (std::string(GenUtils::valueTypeToString(valueType())+";"));
-    returnString += (std::string(GenUtils::nodeTypeToString(nodeType())+";"));
+    returnString += GenUtils::valueTypeToString(valueType());
+    returnString += ";";
+    returnString += GenUtils::nodeTypeToString(nodeType());
+    returnString += ";";
     returnString += (std::string(name()+";"));
     returnString += (std::string(shortName()+";"));
     returnString += "--;";
     return returnString;
 }
 
-bool GraphNode::gatherInboundSocketInfo(std::vector<std::string> *_vec)
-{
-    std::vector<std::string> store;
-    store.clear();
-    std::vector<std::string> temp;
-    temp.clear();
-    for (int  i =0; i < m_numInboundSockets; i++)
-    {
-        if(!m_inboundSockets->at(i)->getConnectedNodeDetails(&temp))
-        {
-            return false;
-        }
-
-        for (int j =0; j < int(temp.size()); j++)
-        {
-            store.push_back(temp.at(j));
-        }
-        temp.clear();
-    }
-    for (int k = 0; k < int(store.size()); k++)
-    {
-        _vec->push_back(store.at(k));
-    }
-    return true;
-}
-
 QPointF GraphNode::centre()
 {
     QRectF box = boundingRect();
@@ -419,6 +516,8 @@ void GraphNode::addInboundSocket()
         temp->setParentNode(this);
         temp->setParentScene(m_parentScene);
         temp->setColour(0,255,0);
+        temp->setPort(PortTypes::create(PortTypes::forNode(m_type),temp));
+        temp->setZValue(zValue()+SOCKET_Z_OFFSET);
         // will need to add the socket to the scene here
         m_parentScene->addSocketToScene(temp);
         m_inboundSockets->push_back(temp);
@@ -436,6 +535,8 @@ void GraphNode::addOutboundSocket()
         temp->setParentNode(this);
         temp->setParentScene(m_parentScene);
         temp->setColour(255,0,0);
+        temp->setPort(PortTypes::create(PortTypes::forNode(m_type),temp));
+        temp->setZValue(zValue()+SOCKET_Z_OFFSET);
         // will need to add the socket to the scene here
         m_parentScene->addSocketToScene(temp);
         m_outboundSockets->push_back(temp);
@@ -486,35 +587,30 @@ void GraphNode::init(VALUE_TYPE _vType, NODE_TYPE _type, QPointF _point)
     // set some flags to allow the node to be interactable
     setFlag(ItemIsMovable);
     setFlag(ItemSendsGeometryChanges);
-    setCacheMode(DeviceCoordinateCache);
-    setZValue(-1);
+    // the cache mode is chosen by the scene's CacheBudget once the node is on screen
+    setZValue(NODE_Z_FLOOR);
 
     m_type = _type;
     m_valueType = _vType;
     m_nodePoint = _point;
 
-    m_zDepth = -1; // this means it has been defaulted and is not on top of another node
+    m_zDepth = -1; // this means the scene has not stacked the node yet
+    m_id = 0; // assigned by the scene
     m_move = false;
 
     m_socketClearence = IN_OUT;
 
-    m_nodeTypeText = new QGraphicsTextItem(this);
-    m_nodeName = new QGraphicsTextItem(this);
-    m_nodeShortName = new QGraphicsTextItem(this);
-    std::string title = GenUtils::nodeTypeToString(m_type);
-    if (title == "__end_node__")
+    m_parentScene = NULL;
+
+    // the text items are only created once the scene shows the node, see showLabels
+    m_nodeTypeText = NULL;
+    m_nodeName = NULL;
+    m_nodeShortName = NULL;
+    m_title = GenUtils::nodeTypeToString(m_type);
+    if (m_title == "__end_node__")
     {
-        title = "";
+        m_title = "";
     }
-    m_nodeTypeText->setPlainText(title.c_str());
-    QFont titleFont;
-    titleFont.setBold(true);
-    m_nodeTypeText->setFont(titleFont);
-    m_nodeTypeText->setPos(getPoint().x()+15.0,getPoint().y()+10.0);
-    m_nodeName->setPlainText(m_name.c_str());
-    m_nodeName->setPos(getPoint().x()+15.0,getPoint().y()+30.0);
-    m_nodeShortName->setPlainText(m_shortName.c_str());
-    m_nodeShortName->setPos(getPoint().x()+15.0,getPoint().y()+50.0);
 
     m_numInboundSockets = 0;
     m_numOutboundSockets = 0;
@@ -0,0 +1,273 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "GraphProgram.h"
+#include "DataflowEngine.h"
+#include "NodeSocket.h"
+#include "GraphEdge.h"
+#include "Utilities.h"
+
+// below this many dirty slots handing them to the worker threads costs more than it saves
+#define PROGRAM_PARALLEL_MIN_SLOTS 64
+
+// executes a single slot on a worker thread
+class SlotTask : public QRunnable
+{
+public:
+    SlotTask(GraphProgram *_program, quint32 _slot) : m_program(_program), m_slot(_slot) {}
+    void run() {m_program->execute(m_slot);}
+
+private:
+    GraphProgram *m_program;
+    quint32 m_slot;
+};
+
+GraphProgram::GraphProgram()
+{
+    m_compiled = false;
+    m_stale = false;
+}
+
+void GraphProgram::compile(GraphNode *_end)
+{
+    // lowering again for the same node keeps what is still clean, removed nodes have already lost their slot
+    QHash<GraphNode*, quint32> previousSlots;
+    std::vector<NodeResult> previousResults;
+    std::vector<quint8> previousDirty;
+    if (m_compiled && root() == _end)
+    {
+        previousSlots.swap(m_slots);
+        previousResults.swap(m_results);
+        previousDirty.swap(m_dirty);
+    }
+    invalidate();
+    if (!_end) return;
+
+    DataflowEngine::upstreamOrder(_end,&m_nodes);
+    m_nodes.push_back(_end);
+
+    int count = int(m_nodes.size());
+    m_slots.reserve(count);
+    for (int i = 0; i < count; i++)
+    {
+        m_slots.insert(m_nodes.at(i),quint32(i));
+    }
+
+    // one instruction per slot reading the slots of everything feeding it
+    std::vector<quint32> dependentCount(count,0);
+    m_instructions.resize(count);
+    for (int i = 0; i < count; i++)
+    {
+        GraphNode *node = m_nodes.at(i);
+        ProgramInstruction &instruction = m_instructions.at(i);
+        instruction.m_op = quint8(i == count - 1 ? OP_GATHER : OP_RECORD);
+        instruction.m_firstOperand = quint32(m_operands.size());
+        for (int j = 0; j < node->numInboundSockets(); j++)
+        {
+            NodeSocket *socket = node->inboundSocket(j);
+            for (int k = 0; k < socket->numEdges(); k++)
+            {
+                quint32 source = m_slots.value(socket->edge(k)->sourceNode());
+                m_operands.push_back(source);
+                dependentCount.at(source)++;
+            }
+        }
+        instruction.m_numOperands = quint32(m_operands.size()) - instruction.m_firstOperand;
+    }
+
+    // the reverse of the operand lists so a change can be pushed downstream without the scene
+    m_firstDependent.resize(count + 1);
+    m_firstDependent.at(0) = 0;
+    for (int i = 0; i < count; i++)
+    {
+        m_firstDependent.at(i+1) = m_firstDependent.at(i) + dependentCount.at(i);
+    }
+    m_dependents.resize(m_operands.size());
+    std::vector<quint32> filled(m_firstDependent.begin(),m_firstDependent.end() - 1);
+    for (int i = 0; i < count; i++)
+    {
+        const ProgramInstruction &instruction = m_instructions.at(i);
+        for (quint32 j = 0; j < instruction.m_numOperands; j++)
+        {
+            quint32 source = m_operands.at(instruction.m_firstOperand + j);
+            m_dependents.at(filled.at(source)++) = quint32(i);
+        }
+    }
+
+    m_results.resize(count);
+    m_dirty.assign(count,1);
+    for (int i = 0; i < count && !previousSlots.isEmpty(); i++)
+    {
+        QHash<GraphNode*, quint32>::const_iterator found = previousSlots.constFind(m_nodes.at(i));
+        if (found != previousSlots.constEnd() && !previousDirty.at(found.value()))
+        {
+            m_results.at(i).m_tokens.swap(previousResults.at(found.value()).m_tokens);
+            m_results.at(i).m_valid = previousResults.at(found.value()).m_valid;
+            m_dirty.at(i) = 0;
+        }
+    }
+    m_compiled = true;
+}
+
+void GraphProgram::invalidate()
+{
+    m_nodes.clear();
+    m_instructions.clear();
+    m_operands.clear();
+    m_firstDependent.clear();
+    m_dependents.clear();
+    m_results.clear();
+    m_dirty.clear();
+    m_slots.clear();
+    m_compiled = false;
+    m_stale = false;
+}
+
+void GraphProgram::reshape(GraphNode *_node)
+{
+    markDirty(_node);
+    m_stale = true;
+}
+
+void GraphProgram::remove(GraphNode *_node)
+{
+    markDirty(_node);
+    // the node may be freed before the next compile so nothing may be looked up by it
+    m_slots.remove(_node);
+    m_stale = true;
+}
+
+void GraphProgram::markDirty(GraphNode *_node)
+{
+    QHash<GraphNode*, quint32>::const_iterator found = m_slots.constFind(_node);
+    if (found == m_slots.constEnd()) return;
+
+    std::vector<quint32> stack;
+    stack.push_back(found.value());
+    while (!stack.empty())
+    {
+        quint32 slot = stack.back();
+        stack.pop_back();
+        // a dirty slot already has dirty dependents
+        if (m_dirty.at(slot)) continue;
+        m_dirty.at(slot) = 1;
+        for (quint32 i = m_firstDependent.at(slot); i < m_firstDependent.at(slot+1); i++)
+        {
+            stack.push_back(m_dependents.at(i));
+        }
+    }
+}
+
+int GraphProgram::run(TaskScheduler *_scheduler)
+{
+    if (!m_compiled) return 0;
+
+    // slots are in topological order so executing them in order sees every operand clean
+    std::vector<quint32> dirty;
+    for (int i = 0; i < int(m_dirty.size()); i++)
+    {
+        if (m_dirty.at(i))
+        {
+            dirty.push_back(quint32(i));
+        }
+    }
+
+    if (_scheduler && _scheduler->threadCount() > 1 && int(dirty.size()) >= PROGRAM_PARALLEL_MIN_SLOTS)
+    {
+        std::vector<int> handles(m_nodes.size(),-1);
+        std::vector<SlotTask*> tasks;
+        tasks.reserve(dirty.size());
+        for (int i = 0; i < int(dirty.size()); i++)
+        {
+            tasks.push_back(new SlotTask(this,dirty.at(i)));
+            handles.at(dirty.at(i)) = _scheduler->addTask(tasks.back());
+        }
+        for (int i = 0; i < int(dirty.size()); i++)
+        {
+            const ProgramInstruction &instruction = m_instructions.at(dirty.at(i));
+            for (quint32 j = 0; j < instruction.m_numOperands; j++)
+            {
+                int input = handles.at(m_operands.at(instruction.m_firstOperand + j));
+                if (input >= 0)
+                {
+                    _scheduler->addDependency(handles.at(dirty.at(i)),input);
+                }
+            }
+        }
+        _scheduler->execute();
+        for (int i = 0; i < int(tasks.size()); i++)
+        {
+            delete tasks.at(i);
+        }
+    }
+    else
+    {
+        for (int i = 0; i < int(dirty.size()); i++)
+        {
+            execute(dirty.at(i));
+        }
+    }
+    return int(dirty.size());
+}
+
+void GraphProgram::nodeRecord(GraphNode *_node, NodeResult *_result)
+{
+    std::string_view type = GenUtils::nodeTypeToString(_node->nodeType());
+    if (type == "" || _node->name() == "" || _node->shortName() == "")
+    {
+        _result->m_valid = false;
+    }
+    _result->m_tokens.clear();
+    _result->m_tokens.push_back(std::string(GenUtils::valueTypeToString(_node->valueType()))+";");
+    _result->m_tokens.push_back(std::string(type)+";");
+    _result->m_tokens.push_back(std::string(_node->name()+";"));
+    _result->m_tokens.push_back(std::string(_node->shortName()+";"));
+    _result->m_tokens.push_back("--;"); // marks where one node ends and the next begins
+}
+
+void GraphProgram::execute(quint32 _slot)
+{
+    const ProgramInstruction &instruction = m_instructions.at(_slot);
+    NodeResult &result = m_results.at(_slot);
+
+    // the slot is only valid if everything it reads is
+    result.m_valid = true;
+    for (quint32 i = 0; result.m_valid && i < instruction.m_numOperands; i++)
+    {
+        result.m_valid = m_results.at(m_operands.at(instruction.m_firstOperand + i)).m_valid;
+    }
+
+    switch (instruction.m_op)
+    {
+        case(OP_RECORD):
+        {
+            nodeRecord(m_nodes.at(_slot),&result);
+        }break;
+        case(OP_GATHER):
+        {
+            // every earlier slot is upstream of this one, in the order they are exported
+            result.m_tokens.clear();
+            result.m_tokens.reserve(_slot * 5);
+            for (quint32 i = 0; i < _slot; i++)
+            {
+                const std::vector<std::string> &tokens = m_results.at(i).m_tokens;
+                result.m_tokens.insert(result.m_tokens.end(),tokens.begin(),tokens.end());
+            }
+        }break;
+    }
+    m_dirty.at(_slot) = 0;
+}
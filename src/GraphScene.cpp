@@ -23,10 +23,30 @@
 #include <QResizeEvent>
 #include <QDialog>
 #include <QSignalMapper>
+#include <QRubberBand>
+#include <QApplication>
+#include <QClipboard>
+#include <QCursor>
+#include <QFutureWatcher>
+#include <QtConcurrent>
 
 #include "Utilities.h"
+#include "ConnectionRules.h"
+#include "Port.h"
+#include "BinaryExport.h"
+#include "LegacyParser.h"
 
 #include<iostream>
+#include <limits.h>
+
+// total bytes the node pixmap caches may use
+#define DEFAULT_CACHE_BUDGET (64 * 1024 * 1024)
+// distance a duplicated selection is placed from the original
+#define DUPLICATE_OFFSET 30.0
+// layout of nodes recreated from an export, in columns left of the end node
+#define RESTORE_COLUMN_SIZE 16
+#define RESTORE_COLUMN_SPACING 260.0
+#define RESTORE_ROW_SPACING 70.0
 
 GraphScene::GraphScene(QWidget *parent) : QGraphicsView(parent)
 {
@@ -42,6 +62,23 @@ GraphScene::GraphScene(QWidget *parent) : QGraphicsView(parent)
 
     setScene(m_scene);
 
+    m_staticLayer = new StaticLayerCache(this,this);
+    connect(m_staticLayer,SIGNAL(ready()),this,SLOT(staticLayerReady()));
+
+    m_cacheBudget = new CacheBudget(this,this);
+    m_cacheBudget->setBudget(DEFAULT_CACHE_BUDGET);
+
+    m_journal = new UndoJournal(this);
+    m_nextNodeId = 1;
+
+    m_changes = new ChangeStream(this);
+    connect(m_changes,SIGNAL(changed(std::vector<GraphChange>)),this,SIGNAL(graphChanged(std::vector<GraphChange>)));
+    m_delta = new DeltaExport(this,m_changes);
+
+    // large recomputes of the graph spread independent branches over every core
+    m_scheduler = new TaskScheduler();
+    m_dataflow.setScheduler(m_scheduler);
+
     setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     setResizeAnchor(AnchorViewCenter);
@@ -52,6 +89,11 @@ GraphScene::GraphScene(QWidget *parent) : QGraphicsView(parent)
 
 GraphScene::~GraphScene()
 {
+    // show any items hidden behind the static layer before they are deleted
+    m_staticLayer->release();
+    // nothing torn down from here on is undoable
+    m_journal->suspend();
+
     delete m_tempSocketForEdgeDrawing;
     delete m_tempEdgeForEdgeDrawing;
 
@@ -69,6 +111,16 @@ GraphScene::~GraphScene()
         m_nodesInScene->clear();
         delete m_nodesInScene;
     }
+    for (int i = 0; i < int(m_labelPool.size()); i++)
+    {
+        delete m_labelPool.at(i);
+    }
+    m_labelPool.clear();
+
+    delete m_journal;
+    delete m_delta;
+    m_dataflow.setScheduler(NULL);
+    delete m_scheduler;
     if (m_scene)
     {
         delete m_scene;
@@ -106,12 +158,6 @@ bool GraphScene::collectInformation(std::string *_string)
 
         if (found)
         {
-            // run through all connected edges on the end node, visit the connected nodes and read their information
-            // as this is an end node, it will only have input sockets
-            std::vector<std::string> temp;
-            temp.clear();
-            // for now I will just ignore any chaining and only look at the ones connected up to the end node
-            // and not anything connected to them as this at the moment does not mean anything
             // i will also look for any member nodes
             for (int i = 0; i < m_numNodesInScene; i++)
             {
@@ -122,61 +168,19 @@ bool GraphScene::collectInformation(std::string *_string)
                 }
             }
 
-            m_nodesInScene->at(endNodeIndex)->gatherInboundSocketInfo(&temp);
-            for (int j =0; j < int(temp.size()); j++)
+            // everything upstream of the end node, however many hops away, each node once and after all that feed it
+            // only the nodes changed since the last export are recomputed
+            // if any of them is incomplete nothing upstream is exported, as before
+            const NodeResult &upstream = m_dataflow.evaluate(m_nodesInScene->at(endNodeIndex));
+            if (upstream.m_valid)
             {
-                gatherVector.push_back(temp.at(j));
+                gatherVector.insert(gatherVector.end(),upstream.m_tokens.begin(),upstream.m_tokens.end());
             }
-            temp.clear();
-
 
             // now we have all the information, need to check none of it is repeated
-            // I know that node types will always follow a -- so when one of these is found, skip the next
-            bool valid = true;
-            int count = 0;
-            int countj = 0;
-
-            while (countj < int(gatherVector.size()))
+            if (!GenUtils::tokensUnique(gatherVector))
             {
-                if (gatherVector.at(countj) == "--;")
-                {
-                    countj +=2;
-                }
-                else
-                {
-                    while (valid && count < int(gatherVector.size()))
-                    {
-
-                        if (countj != count)
-                        {
-                            if (gatherVector.at(count) == "--;")
-                            {
-                                count += 2;
-                            }
-                            else
-                            {
-                                if (gatherVector.at(countj) == gatherVector.at(count))
-                                {
-                                    valid = false;
-                                }
-                                else
-                                {
-                                    count++;
-                                }
-                            }
-                        }
-                        else
-                        {
-                            count++;
-                        }
-                    }
-                    if (!valid)
-                    {
-                        return false;
-                    }
-                    count = 0;
-                    countj++;
-                }
+                return false;
             }
         }
         else
@@ -198,6 +202,162 @@ bool GraphScene::collectInformation(std::string *_string)
     return false;
 }
 
+bool GraphScene::saveGraph(const QString &_fileName)
+{
+    Subgraph graph;
+    graph.capture(*m_nodesInScene,true);
+    return graph.save(_fileName);
+}
+
+bool GraphScene::collectBinary(QByteArray *_data)
+{
+    std::vector<GraphNode*> nodes;
+    GraphNode *end = NULL;
+    if (!exportedNodes(&nodes,&end)) return false;
+
+    // the same graph collectInformation gives, the tokens upstream of the end node come from the same evaluation
+    // so an incomplete node there leaves out everything upstream and a repeated token refuses the whole export
+    const NodeResult &upstream = m_dataflow.evaluate(end);
+    std::vector<std::string> gatherVector;
+    std::vector<GraphNode*> exported;
+    for (int i = 0; i < int(nodes.size()); i++)
+    {
+        if (nodes.at(i)->valueType() == VT_MEMBER)
+        {
+            gatherVector.push_back(nodes.at(i)->getNodeInfo());
+            exported.push_back(nodes.at(i));
+        }
+        else if (upstream.m_valid)
+        {
+            exported.push_back(nodes.at(i));
+        }
+    }
+    if (upstream.m_valid)
+    {
+        gatherVector.insert(gatherVector.end(),upstream.m_tokens.begin(),upstream.m_tokens.end());
+    }
+    if (!GenUtils::tokensUnique(gatherVector)) return false;
+
+    nodes.swap(exported);
+    nodes.push_back(end);
+    BinaryExport::write(nodes,_data);
+    return true;
+}
+
+bool GraphScene::restoreInformation(std::string_view _export)
+{
+    GraphNode *end = NULL;
+    for (int i = 0; !end && i < m_numNodesInScene; i++)
+    {
+        if (m_nodesInScene->at(i)->endNode())
+        {
+            end = m_nodesInScene->at(i);
+        }
+    }
+    if (!end) return false;
+
+    std::vector<LegacyRecord> records;
+    std::string error;
+    if (!LegacyParser::parse(_export,&records,&error))
+    {
+#ifdef DEBUG
+        std::cerr<<"Could not read export: "<<error<<std::endl;
+#endif
+        return false;
+    }
+
+    // every node that can feed anything is joined to the end node, check they all may be before creating any
+    for (int i = 0; i < int(records.size()); i++)
+    {
+        const LegacyRecord &record = records.at(i);
+        if (record.m_valueType != VT_MEMBER &&
+            (end->numInboundSockets() == 0 || !ConnectionRules::compatible(record.m_valueType,record.m_nodeType,end->valueType())))
+        {
+            return false;
+        }
+    }
+
+    // lay the nodes out in columns to the left of the end node, the same shape the menus create them in
+    Subgraph subgraph;
+    int columns = (int(records.size()) + RESTORE_COLUMN_SIZE - 1) / RESTORE_COLUMN_SIZE;
+    for (int i = 0; i < int(records.size()); i++)
+    {
+        const LegacyRecord &record = records.at(i);
+        SubgraphNode node;
+        node.m_valueType = record.m_valueType;
+        node.m_nodeType = record.m_nodeType;
+        node.m_point = QPointF((i / RESTORE_COLUMN_SIZE) * RESTORE_COLUMN_SPACING,(i % RESTORE_COLUMN_SIZE) * RESTORE_ROW_SPACING);
+        node.m_width = record.m_valueType == VT_OBJECT ? 200.0 : 160.0;
+        node.m_baseWidth = node.m_width;
+        node.m_editable = true;
+        node.m_deletable = true;
+        node.m_numInbound = record.m_valueType == VT_OBJECT ? 1 : 0;
+        node.m_numOutbound = record.m_valueType == VT_MEMBER ? 0 : 1;
+        node.m_name = std::string(record.m_name);
+        node.m_shortName = std::string(record.m_shortName);
+        subgraph.addNode(node);
+    }
+    int refused = 0;
+    insertSubgraph(subgraph,end->getPoint() - QPointF(columns * RESTORE_COLUMN_SPACING,0.0),end,&refused);
+    return refused == 0;
+}
+
+bool GraphScene::exportedNodes(std::vector<GraphNode*> *_nodes, GraphNode **_end)
+{
+    GraphNode *end = NULL;
+    QSet<GraphNode*> seen;
+    for (int i = 0; i < m_numNodesInScene; i++)
+    {
+        GraphNode *node = m_nodesInScene->at(i);
+        if (node->endNode())
+        {
+            end = node;
+        }
+        else if (node->valueType() == VT_MEMBER)
+        {
+            _nodes->push_back(node);
+            seen.insert(node);
+        }
+    }
+    if (!end) return false;
+    if (_end) *_end = end;
+
+    std::vector<GraphNode*> upstream;
+    DataflowEngine::upstreamOrder(end,&upstream);
+    for (int i = 0; i < int(upstream.size()); i++)
+    {
+        if (!seen.contains(upstream.at(i)))
+        {
+            _nodes->push_back(upstream.at(i));
+        }
+    }
+    return true;
+}
+
+// runs on a worker thread, the snapshot is a copy so the scene may change underneath
+static ExportResult exportSnapshot(const GraphSnapshot &_snapshot)
+{
+    return _snapshot.exportGraph();
+}
+
+QFuture<ExportResult> GraphScene::collectInformationAsync()
+{
+    // taking the snapshot only copies a handle, edits made while the export runs copy the records they touch
+    QFuture<ExportResult> future = QtConcurrent::run(exportSnapshot,m_mirror.snapshot());
+    QFutureWatcher<ExportResult> *watcher = new QFutureWatcher<ExportResult>(this);
+    connect(watcher,SIGNAL(finished()),this,SLOT(informationReady()));
+    watcher->setFuture(future);
+    return future;
+}
+
+void GraphScene::informationReady()
+{
+    QFutureWatcher<ExportResult> *watcher = static_cast<QFutureWatcher<ExportResult>*>(sender());
+    ExportResult result = watcher->result();
+    watcher->deleteLater();
+    emit informationCollected(result.m_ok,QString::fromStdString(result.m_ok ? result.m_string : result.m_error));
+}
+
 void GraphScene::printAllNodes()
 {
     std::cout<<"####################################################################"<<std::endl;
@@ -219,6 +379,10 @@ void GraphScene::init()
 
     m_nodeSelected = false;
     m_editingNode = false;
+    m_selectingArea = false;
+    m_batchDepth = 0;
+
+    m_rubberBand = new QRubberBand(QRubberBand::Rectangle,viewport());
 
     m_endNodeInScene = false;
 
@@ -233,6 +397,7 @@ void GraphScene::init()
     m_nodeEdit = new NodeEdit(this);
 
     m_numNodesInScene = 0;
+    m_nextZDepth = 0;
 
     m_nodeActive = false; // no node is currently active
 
@@ -272,7 +437,10 @@ void GraphScene::addEndNode(std::string _title)
 {
     if (!m_endNodeInScene)
     {
+        // the end node can not be deleted so it must not be undoable either
+        m_journal->suspend();
         addNodeToScene(VT_END,NT_ENDNODE,QPointF(0.0,0.0),this,1,0,false,false);
+        m_journal->resume();
         // this will now be the last one in the node list so can access it there
         m_nodesInScene->at(m_numNodesInScene-1)->setNodeTitle(_title);
         m_nodesInScene->at(m_numNodesInScene-1)->setEndNode(true);
@@ -289,56 +457,31 @@ bool GraphScene::nodeAtPoint(QPoint _point)
 
 bool GraphScene::nodeAtPoint(qreal _x, qreal _y)
 {
-    // loop through all nodes in the scene and check if they exist over the given point
-    std::vector<GraphNode*> nodesFound; // vector of possible nodes at point if more than one are at that point
-    // if more than one, then it will select the node with the greatest zDepth value
-    // a node is found only if the vector length is 0
-    nodesFound.clear();
-
-    int numFound = 0;
+    // only the nodes sharing a grid cell with the point can be under it
+    std::vector<GraphNode*> candidates;
+    m_nodeIndex.query(QRectF(_x,_y,0.0,0.0),&candidates);
 
-    for (int i = 0; i < m_numNodesInScene; i++)
+    // every node has its own depth so the topmost node under the point is found in a single pass
+    GraphNode *top = NULL;
+    for (int i = 0; i < int(candidates.size()); i++)
     {
-        if (m_nodesInScene->at(i)->nodeOverPoint(_x,_y))
+        GraphNode *node = candidates.at(i);
+        if ((!top || node->zDepth() > top->zDepth()) && node->nodeOverPoint(_x,_y))
         {
-            nodesFound.push_back(m_nodesInScene->at(i));
-            numFound++;
+            top = node;
         }
     }
 
-    // check if any have been found, if they have not then we can simply return false
-    if (numFound == 0)
+    if (top == NULL)
     {
-        activeNodeSelected(false);
+        // only a hit test, the selection is left for the caller to change
         m_activeSelectedNode = NULL;
         return false;
     }
 
-    // now we need to check if there is mroe than 1 node. If there is only one node, we can set the active
-    // node and then return true
-    if (numFound == 1)
-    {
-        m_activeSelectedNode = nodesFound.at(0);
-        return true;
-    }
-
-    // if we have got this far then there are multiple nodes at this point so we need to check their zDepth
-    // the one with the highest value will be selected
-    int z = 0;
-    int indexToUse = 0;
-
-    for (int n = 0; n < numFound; n++)
-    {
-        int depth = nodesFound.at(n)->zDepth();
-        if (depth > z)
-        {
-            z = depth;
-            indexToUse = n;
-        }
-    }
-
-    // now set the active node to the top node and return true
-    m_activeSelectedNode = nodesFound.at(indexToUse);
+    // nodeOverPoint stores the cursor offset used while dragging, make sure it is the chosen node's
+    top->nodeOverPoint(_x,_y);
+    m_activeSelectedNode = top;
     return true;
 }
 
@@ -358,14 +501,46 @@ void GraphScene::keyPressEvent(QKeyEvent *_event)
             emit nodeMenuRequested(p);
         }
     }
+    else if (_event->modifiers() & Qt::ControlModifier)
+    {
+        switch (_event->key())
+        {
+            case(Qt::Key_C): copySelection(); break;
+            case(Qt::Key_X): cutSelection(); break;
+            case(Qt::Key_V): pasteClipboard(); break;
+            case(Qt::Key_D): duplicateSelection(); break;
+            case(Qt::Key_Z):
+                if (_event->modifiers() & Qt::ShiftModifier)
+                {
+                    redo();
+                }
+                else
+                {
+                    undo();
+                }
+                break;
+            case(Qt::Key_Y): redo(); break;
+        }
+    }
     else if (_event->key() == Qt::Key_Backspace || _event->key() == Qt::Key_Delete)
     {
-        if (m_nodeSelected)
+        if (m_selection.size() > 1)
+        {
+            m_activeInboundSocket = NULL;
+            m_activeOutboundSocket = NULL;
+            std::vector<GraphNode*> selected;
+            for (QSet<GraphNode*>::const_iterator it = m_selection.constBegin(); it != m_selection.constEnd(); ++it)
+            {
+                selected.push_back(*it);
+            }
+            removeNodes(selected);
+        }
+        else if (m_selection.size() == 1)
         {
             m_activeInboundSocket = NULL;
             m_activeOutboundSocket = NULL;
-            // now need to delete the selected node
-            removeNode(m_activeSelectedNode);
+            // now need to delete the selected node, which need not be the last one clicked
+            removeNode(*m_selection.constBegin());
         }
     }
     update();
@@ -398,8 +573,11 @@ void GraphScene::mouseMoveEvent(QMouseEvent *_event)
         QPointF conv = mapToScene(_event->x(),_event->y());
         // need to add the offset of the cursor within the nodes area to stop it jumping to the mouse cursor
         conv += m_activeSelectedNode->getOffsetToCursor();
-        m_activeSelectedNode->setPoint(conv);
-        m_activeSelectedNode->updateSockets();
+        moveDragGroup(conv - m_activeSelectedNode->getPoint());
+    }
+    else if (m_selectingArea)
+    {
+        m_rubberBand->setGeometry(QRect(m_rubberBandOrigin,_event->pos()).normalized());
     }
     else if (m_creatingEdge)
     {
@@ -418,11 +596,21 @@ void GraphScene::mouseMoveEvent(QMouseEvent *_event)
             m_activeInboundSocket = m_nodesInScene->at(index)->cursorOverSocket(conv.x(),conv.y(),SK_INBOUND);
             if (m_activeInboundSocket != NULL)
             {
-                m_cursorOverInboundSocket = true;
+                // an edge that would close a cycle is never offered
+                m_cursorOverInboundSocket = canConnectSockets(m_activeOutboundSocket,m_activeInboundSocket);
                 found = true;
             }
             index++;
         }
+
+        if (found && !m_cursorOverInboundSocket)
+        {
+            viewport()->setCursor(Qt::ForbiddenCursor);
+        }
+        else
+        {
+            viewport()->unsetCursor();
+        }
     }
     else // else user is just moving the mouse so we can test for inbound sockets
     {
@@ -468,6 +656,8 @@ void GraphScene::mousePressEvent(QMouseEvent *_event)
         if (nodeAtPoint(conv.x(),conv.y()))
         {
             m_moveNode = true;
+            beginDrag(m_activeSelectedNode);
+            cacheStaticLayer();
         }
     }
     if (_event->buttons() ==Qt::LeftButton)
@@ -483,10 +673,28 @@ void GraphScene::mousePressEvent(QMouseEvent *_event)
         }
         else
         {
-            activeNodeSelected(false);
+            bool additive = _event->modifiers() & Qt::ShiftModifier;
             if (nodeAtPoint(conv.x(),conv.y()))
             {
+                // clicking a node that is already part of the selection keeps the selection so it can be dragged as a group
+                if (!additive && !m_selection.contains(m_activeSelectedNode))
+                {
+                    clearSelection();
+                }
                 activeNodeSelected(true);
+                raiseNode(m_activeSelectedNode);
+            }
+            else
+            {
+                // empty space, start selecting an area
+                if (!additive)
+                {
+                    clearSelection();
+                }
+                m_selectingArea = true;
+                m_rubberBandOrigin = _event->pos();
+                m_rubberBand->setGeometry(QRect(m_rubberBandOrigin,QSize()));
+                m_rubberBand->show();
             }
         }
     }
@@ -505,6 +713,8 @@ void GraphScene::mouseDoubleClickEvent(QMouseEvent *_event)
             {
                 // flag that a node is being modified
                 m_editingNode = true;
+                // everything typed in this edit is one step
+                m_journal->seal();
                 // bring up window here to modify the active node
                 // will be my own made ui
                 m_nodeEdit->setNodeToEdit(m_activeSelectedNode);
@@ -528,13 +738,52 @@ void GraphScene::mouseReleaseEvent(QMouseEvent *_event)
 
     if (m_moveNode)
     {
+        m_staticLayer->release();
         m_moveNode = false;
         m_activeSelectedNode = NULL;
+
+        // the whole drag is a single step however many mouse moves it took
+        JournalEntry entry;
+        for (int i = 0; i < int(m_dragGroup.size()); i++)
+        {
+            if (m_dragGroup.at(i)->getPoint() != m_dragStart.at(i))
+            {
+                JournalMove move;
+                move.m_id = m_dragGroup.at(i)->id();
+                move.m_from = m_dragStart.at(i);
+                move.m_to = m_dragGroup.at(i)->getPoint();
+                entry.m_moves.push_back(move);
+            }
+        }
+        if (!entry.m_moves.empty())
+        {
+            m_journal->record(entry);
+        }
+        m_dragGroup.clear();
+        m_dragEdges.clear();
+    }
+
+    if (m_selectingArea)
+    {
+        m_rubberBand->hide();
+        m_selectingArea = false;
+        QRect area = QRect(m_rubberBandOrigin,_event->pos()).normalized();
+        selectNodesInRect(mapToScene(area).boundingRect());
     }
 
     if (m_cursorOverInboundSocket)
     {
-        m_activeOutboundSocket->addEdge(m_activeInboundSocket);
+        GraphEdge *edge = connectSockets(m_activeOutboundSocket,m_activeInboundSocket);
+        if (edge && m_journal->recording())
+        {
+            JournalEntry entry;
+            entry.m_addedEdges.push_back(edgeRecord(edge));
+            m_journal->record(entry);
+        }
+    }
+    if (m_creatingEdge)
+    {
+        viewport()->unsetCursor();
     }
 
     m_creatingEdge = false;
@@ -567,6 +816,7 @@ void GraphScene::wheelEvent(QWheelEvent *_event)
 
 void GraphScene::resizeEvent(QResizeEvent *event)
 {
+    viewChanged();
     viewport()->update();
 }
 
@@ -574,54 +824,366 @@ void GraphScene::addNodeToScene(VALUE_TYPE _valueTy, NODE_TYPE _type, QPointF _p
 {
     if (m_scene != NULL)
     {
-        m_nodesInScene->push_back(new GraphNode(_point, _valueTy, _type));
-        m_nodesInScene->at(m_numNodesInScene)->setParentScene(_parent);
-        m_nodesInScene->at(m_numNodesInScene)->setDeletable(_deletable);
-        m_nodesInScene->at(m_numNodesInScene)->setEditable(_editable);
-        if (_valueTy == VT_OBJECT)
+        updateMaterializedRegion();
+        GraphNode *node = createNode(_valueTy,_type,_point,_parent,_inboundSK,_outboundSK,_editable,_deletable);
+        if (m_journal->recording())
         {
-            // if it is an object, as some of the names are longer, need to widen it a little
-            m_nodesInScene->at(m_numNodesInScene)->setWidth(200.0f);
-            m_nodesInScene->at(m_numNodesInScene)->setBaseWidth(200.0f);
+            JournalEntry entry;
+            JournalNode created;
+            created.m_id = node->id();
+            created.m_record = Subgraph::recordNode(node);
+            entry.m_createdNodes.push_back(created);
+            m_journal->record(entry);
         }
+    }
+    scheduleRepaint();
+}
+
+GraphNode *GraphScene::createNode(VALUE_TYPE _valueTy, NODE_TYPE _type, QPointF _point, GraphScene *_parent, int _inboundSK, int _outboundSK, bool _editable, bool _deletable, quint32 _id)
+{
+    m_nodesInScene->push_back(new GraphNode(_point, _valueTy, _type));
+    m_nodesInScene->at(m_numNodesInScene)->setParentScene(_parent);
+    m_nodesInScene->at(m_numNodesInScene)->setDeletable(_deletable);
+    m_nodesInScene->at(m_numNodesInScene)->setEditable(_editable);
+    if (_valueTy == VT_OBJECT)
+    {
+        // if it is an object, as some of the names are longer, need to widen it a little
+        m_nodesInScene->at(m_numNodesInScene)->setWidth(200.0f);
+        m_nodesInScene->at(m_numNodesInScene)->setBaseWidth(200.0f);
+    }
+
+    for (int i =0 ; i < _inboundSK; i++)
+    {
+        m_nodesInScene->at(m_numNodesInScene)->addSocket(SK_INBOUND);
+    }
+    for (int j =0 ; j < _outboundSK; j++)
+    {
+        m_nodesInScene->at(m_numNodesInScene)->addSocket(SK_OUTBOUND);
+    }
+
+    GraphNode *node = m_nodesInScene->at(m_numNodesInScene);
+    // the id is set before anything is told about the node, a restored node takes back the one it had
+    if (_id == 0)
+    {
+        _id = m_nextNodeId;
+    }
+    if (m_nextNodeId <= _id)
+    {
+        m_nextNodeId = _id + 1;
+    }
+    node->setId(_id);
+    m_nodeIds.insert(node->id(),node);
+    m_topology.addNode(node);
+    m_mirror.addNode(node);
+    m_changes->nodeAdded(node);
+    // new nodes go on top
+    raiseNode(node);
+    m_nodeIndex.insert(node,node->sceneBoundingRect());
+    syncNode(node);
+    m_numNodesInScene++;
+    return node;
+}
+
+std::vector<GraphNode*> GraphScene::insertSubgraph(const Subgraph &_subgraph, QPointF _origin, GraphNode *_sink,
+                                                   int *_refused)
+{
+    std::vector<GraphNode*> created;
+    int refused = 0;
+    if (_refused) *_refused = 0;
+    if (m_scene == NULL || _subgraph.isEmpty()) return created;
+
+    beginBatch();
+    // the whole insertion is recorded as one step below
+    m_journal->suspend();
+    updateMaterializedRegion();
+
+    const std::vector<SubgraphNode> &nodes = _subgraph.nodes();
+    m_nodesInScene->reserve(m_numNodesInScene + nodes.size());
+    created.reserve(nodes.size());
+    for (int i = 0; i < int(nodes.size()); i++)
+    {
+        const SubgraphNode &record = nodes.at(i);
+        GraphNode *node = createNode(record.m_valueType,record.m_nodeType,_origin + record.m_point,this,
+                                     record.m_numInbound,record.m_numOutbound,record.m_editable,record.m_deletable);
+        node->setBaseWidth(record.m_baseWidth);
+        node->setWidth(record.m_width);
+        node->setName(record.m_name);
+        node->setShortName(record.m_shortName);
+        created.push_back(node);
+    }
 
-        for (int i =0 ; i < _inboundSK; i++)
+    const std::vector<SubgraphEdge> &edges = _subgraph.edges();
+    for (int i = 0; i < int(edges.size()); i++)
+    {
+        const SubgraphEdge &record = edges.at(i);
+        NodeSocket *source = created.at(record.m_sourceNode)->outboundSocket(record.m_sourceSocket);
+        if (!connectSockets(source,created.at(record.m_destinationNode)->inboundSocket(record.m_destinationSocket)))
+        {
+            refused++;
+        }
+    }
+    if (_sink && _sink->numInboundSockets() > 0)
+    {
+        for (int i = 0; i < int(created.size()); i++)
         {
-            m_nodesInScene->at(m_numNodesInScene)->addSocket(SK_INBOUND);
+            if (created.at(i)->numOutboundSockets() > 0 &&
+                !connectSockets(created.at(i)->outboundSocket(0),_sink->inboundSocket(0)))
+            {
+                refused++;
+            }
         }
-        for (int j =0 ; j < _outboundSK; j++)
+    }
+    if (_refused) *_refused = refused;
+
+    m_journal->resume();
+    if (m_journal->recording())
+    {
+        JournalEntry entry;
+        for (int i = 0; i < int(created.size()); i++)
         {
-            m_nodesInScene->at(m_numNodesInScene)->addSocket(SK_OUTBOUND);
+            JournalNode record;
+            record.m_id = created.at(i)->id();
+            record.m_record = Subgraph::recordNode(created.at(i));
+            entry.m_createdNodes.push_back(record);
+            for (int j = 0; j < created.at(i)->numOutboundSockets(); j++)
+            {
+                NodeSocket *socket = created.at(i)->outboundSocket(j);
+                for (int k = 0; k < socket->numEdges(); k++)
+                {
+                    entry.m_addedEdges.push_back(edgeRecord(socket->edge(k)));
+                }
+            }
         }
+        m_journal->record(entry);
+    }
 
-        m_scene->addItem(m_nodesInScene->at(m_numNodesInScene));
-        m_numNodesInScene++;
+    // the new nodes become the selection so they can be moved straight away
+    clearSelection();
+    for (int i = 0; i < int(created.size()); i++)
+    {
+        created.at(i)->setSelectedNode(true);
+        m_selection.insert(created.at(i));
     }
-    viewport()->update();
+
+    endBatch();
+    return created;
+}
+
+bool GraphScene::canConnectSockets(NodeSocket *_source, NodeSocket *_destination)
+{
+    if (!_source || !_destination) return false;
+    if (_source->getSocketType() != SK_OUTBOUND || _destination->getSocketType() != SK_INBOUND) return false;
+    // the constant time checks go first as this runs on every mouse move while dragging an edge
+    if (_source->isConnectedTo(_destination)) return false;
+    if (!ConnectionRules::compatible(_source->getParentNode(),_destination->getParentNode())) return false;
+    if (_source->port() && _destination->port() && !_destination->port()->accepts(_source->port())) return false;
+
+    return m_topology.canConnect(_source->getParentNode(),_destination->getParentNode());
+}
+
+GraphEdge *GraphScene::connectSockets(NodeSocket *_source, NodeSocket *_destination)
+{
+    if (!_source || !_destination) return NULL;
+    if (_source->getSocketType() != SK_OUTBOUND || _destination->getSocketType() != SK_INBOUND) return NULL;
+    if (_source->isConnectedTo(_destination))
+    {
+#ifdef DEBUG
+        std::cout<<"Refusing edge as the sockets are already connected"<<std::endl;
+#endif
+        return NULL;
+    }
+    if (!ConnectionRules::compatible(_source->getParentNode(),_destination->getParentNode()))
+    {
+#ifdef DEBUG
+        std::cout<<"Refusing edge between incompatible node types"<<std::endl;
+#endif
+        return NULL;
+    }
+    if (_source->port() && _destination->port() && !_destination->port()->accepts(_source->port()))
+    {
+#ifdef DEBUG
+        std::cout<<"Refusing edge as the port types do not match"<<std::endl;
+#endif
+        return NULL;
+    }
+
+    // reorders the nodes between the two ends if needed, refusing the edge if it would close a cycle
+    if (!m_topology.connect(_source->getParentNode(),_destination->getParentNode()))
+    {
+#ifdef DEBUG
+        std::cout<<"Refusing edge as it would create a cycle"<<std::endl;
+#endif
+        return NULL;
+    }
+
+    _source->addEdge(_destination);
+    return _source->edge(_source->numEdges()-1);
+}
+
+std::vector<GraphNode*> GraphScene::selectedNodes()
+{
+    std::vector<GraphNode*> selected;
+    for (QSet<GraphNode*>::const_iterator it = m_selection.constBegin(); it != m_selection.constEnd(); ++it)
+    {
+        selected.push_back(*it);
+    }
+    return selected;
+}
+
+void GraphScene::copySelection()
+{
+    Subgraph subgraph;
+    subgraph.capture(selectedNodes());
+    if (subgraph.isEmpty()) return;
+
+    QApplication::clipboard()->setMimeData(subgraph.toMimeData());
+}
+
+void GraphScene::cutSelection()
+{
+    copySelection();
+    m_activeInboundSocket = NULL;
+    m_activeOutboundSocket = NULL;
+    removeNodes(selectedNodes());
+}
+
+void GraphScene::pasteClipboard()
+{
+    Subgraph subgraph;
+    if (!subgraph.fromMimeData(QApplication::clipboard()->mimeData())) return;
+
+    // paste under the cursor if it is over the graph, otherwise just off from where it was copied
+    QPoint cursor = viewport()->mapFromGlobal(QCursor::pos());
+    QPointF origin = subgraph.origin() + QPointF(DUPLICATE_OFFSET,DUPLICATE_OFFSET);
+    if (viewport()->rect().contains(cursor))
+    {
+        origin = mapToScene(cursor);
+    }
+    insertSubgraph(subgraph,origin);
+}
+
+void GraphScene::duplicateSelection()
+{
+    Subgraph subgraph;
+    subgraph.capture(selectedNodes());
+    if (subgraph.isEmpty()) return;
+
+    insertSubgraph(subgraph,subgraph.origin() + QPointF(DUPLICATE_OFFSET,DUPLICATE_OFFSET));
 }
 
 void GraphScene::addEdgeToScene(GraphEdge *_edge)
 {
     if (m_scene && _edge)
     {
-        m_scene->addItem(_edge);
+        if (_edge == m_tempEdgeForEdgeDrawing)
+        {
+            // the edge being drawn follows the cursor so it is never indexed
+            m_scene->addItem(_edge);
+        }
+        else
+        {
+            m_edgeIndex.insertLine(_edge,_edge->line(),_edge->arrowSize());
+            syncEdge(_edge);
+            m_dataflow.edgeChanged(_edge);
+            m_mirror.addEdge(_edge);
+            m_changes->edgeConnected(edgeRecord(_edge));
+        }
     }
-    viewport()->update();
+    scheduleRepaint();
 }
 
 void GraphScene::addSocketToScene(NodeSocket *_socket)
 {
-    if (m_scene && _socket)
+    // sockets follow their node in and out of the scene, see materializeNode
+    if (m_scene && _socket && m_materializedNodes.contains(_socket->getParentNode()))
     {
         m_scene->addItem(_socket);
     }
-    viewport()->update();
+    scheduleRepaint();
 }
 
 void GraphScene::removeFromScene(QGraphicsItem *_item)
 {
-    m_scene->removeItem(_item);
-    viewport()->update();
+    GraphNode *node = qgraphicsitem_cast<GraphNode*>(_item);
+    if (node)
+    {
+        m_nodeIndex.remove(node);
+        m_materializedNodes.remove(node);
+        m_zOrder.erase(node->zDepth());
+        m_selection.remove(node);
+        m_nodeIds.remove(node->id());
+        m_topology.removeNode(node);
+        m_dataflow.forget(node);
+        m_mirror.removeNode(node);
+        m_changes->nodeRemoved(node->id());
+        m_cacheBudget->release(node);
+    }
+    GraphEdge *edge = qgraphicsitem_cast<GraphEdge*>(_item);
+    if (edge && edge != m_tempEdgeForEdgeDrawing)
+    {
+        m_edgeIndex.remove(edge);
+        m_materializedEdges.remove(edge);
+        m_dataflow.edgeChanged(edge);
+        m_mirror.removeEdge(edge);
+        m_changes->edgeDisconnected(edgeRecord(edge));
+    }
+
+    // items away from the viewport are not in the scene at all
+    if (_item->scene() == m_scene)
+    {
+        m_scene->removeItem(_item);
+    }
+    scheduleRepaint();
+}
+
+void GraphScene::nodeGeometryChanged(GraphNode *_node)
+{
+    if (!m_nodeIndex.contains(_node)) return;
+
+    m_nodeIndex.insert(_node,_node->sceneBoundingRect());
+    m_changes->nodeMoved(_node);
+    syncNode(_node);
+    if (m_materializedNodes.contains(_node))
+    {
+        // a resized node needs a differently sized pixmap
+        m_cacheBudget->touch(_node);
+    }
+
+    // the scene rect is fixed while items stream in and out, so grow it by hand to keep the whole graph reachable
+    QRectF bounds = m_scene->sceneRect().united(_node->sceneBoundingRect());
+    if (bounds != m_scene->sceneRect())
+    {
+        m_scene->setSceneRect(bounds);
+    }
+}
+
+void GraphScene::edgeGeometryChanged(GraphEdge *_edge)
+{
+    if (!m_edgeIndex.contains(_edge)) return;
+
+    m_edgeIndex.insertLine(_edge,_edge->line(),_edge->arrowSize());
+    syncEdge(_edge);
+}
+
+QGraphicsTextItem *GraphScene::takeLabel()
+{
+    if (m_labelPool.empty())
+    {
+        return new QGraphicsTextItem();
+    }
+    QGraphicsTextItem *label = m_labelPool.back();
+    m_labelPool.pop_back();
+    return label;
+}
+
+void GraphScene::returnLabel(QGraphicsTextItem *_label)
+{
+    _label->setParentItem(NULL);
+    if (_label->scene() == m_scene)
+    {
+        m_scene->removeItem(_label);
+    }
+    m_labelPool.push_back(_label);
 }
 
 void GraphScene::zoomIn()
@@ -629,6 +1191,7 @@ void GraphScene::zoomIn()
     setTransformationAnchor(AnchorUnderMouse);
     scale(1.08, 1.08);
     setTransformationAnchor(AnchorViewCenter);
+    viewChanged();
 }
 
 void GraphScene::zoomOut()
@@ -636,12 +1199,20 @@ void GraphScene::zoomOut()
     setTransformationAnchor(QGraphicsView::AnchorUnderMouse);
     scale(0.92, 0.92);
     setTransformationAnchor(AnchorViewCenter);
+    viewChanged();
+}
+
+void GraphScene::navScene(qreal _x, qreal _y)
+{
+    translate(_x,_y);
+    viewChanged();
 }
 
 void GraphScene::createObjectNode(int _type)
 {
     NODE_TYPE temp = static_cast<NODE_TYPE>(_type);
-    addNodeToScene(VT_OBJECT,temp,m_createNodeAt,this,0,1);
+    // objects take an inbound socket so arguments and other objects can be chained into them
+    addNodeToScene(VT_OBJECT,temp,m_createNodeAt,this,1,1);
 }
 
 void GraphScene::createArgumentNode(int _type)
@@ -662,36 +1233,300 @@ bool GraphScene::removeNode(GraphNode *_nodeToRemove)
 
     if (findNodeIndex(_nodeToRemove,&indexToRemove))
     {
-        if (m_nodesInScene->at(indexToRemove)->deletable())
-        {
-            activeNodeSelected(false);
-            m_activeSelectedNode = NULL;
-            removeFromScene(m_nodesInScene->at(indexToRemove));
-            delete m_nodesInScene->at(indexToRemove);
+        // a single node goes through the bulk path so it is torn down and journaled the same way
+        std::vector<GraphNode*> nodes(1,_nodeToRemove);
+        return removeNodes(nodes) == 1;
+    }
+    return false;
+}
+
+int GraphScene::removeNodes(const std::vector<GraphNode*> &_nodes)
+{
+    QSet<GraphNode*> removing;
+    for (int i = 0; i < int(_nodes.size()); i++)
+    {
+        if (_nodes.at(i) && _nodes.at(i)->deletable())
+        {
+            removing.insert(_nodes.at(i));
+        }
+    }
+    if (removing.isEmpty()) return 0;
 
-            for (int i = indexToRemove; i < m_numNodesInScene - 1; i++)
+    // the static layer may be hiding items connected to these nodes
+    m_staticLayer->release();
+    m_moveNode = false;
+    m_dragGroup.clear();
+    m_dragEdges.clear();
+    if (removing.contains(m_activeSelectedNode))
+    {
+        activeNodeSelected(false);
+        m_activeSelectedNode = NULL;
+    }
+
+    // gather every edge touching a removed node once, along with the surviving sockets at their far ends
+    QSet<GraphEdge*> edges;
+    QSet<NodeSocket*> survivors;
+    for (QSet<GraphNode*>::const_iterator it = removing.constBegin(); it != removing.constEnd(); ++it)
+    {
+        GraphNode *node = *it;
+        for (int i = 0; i < node->numInboundSockets() + node->numOutboundSockets(); i++)
+        {
+            NodeSocket *socket = i < node->numInboundSockets() ? node->inboundSocket(i) : node->outboundSocket(i - node->numInboundSockets());
+            for (int j = 0; j < socket->numEdges(); j++)
             {
-                m_nodesInScene->at(i) = m_nodesInScene->at(i+1);
+                GraphEdge *edge = socket->edge(j);
+                edges.insert(edge);
+                NodeSocket *other = edge->sourceSocket() == socket ? edge->destinationSocket() : edge->sourceSocket();
+                if (!removing.contains(other->getParentNode()))
+                {
+                    survivors.insert(other);
+                }
             }
+            // the edges are freed below so the node destructor has nothing left to tear down
+            socket->clearEdgeReferences();
+        }
+    }
 
-            m_numNodesInScene--;
-            m_nodesInScene->resize(m_numNodesInScene);
-            return true;
+    if (m_journal->recording())
+    {
+        JournalEntry entry;
+        for (QSet<GraphEdge*>::const_iterator it = edges.constBegin(); it != edges.constEnd(); ++it)
+        {
+            entry.m_removedEdges.push_back(edgeRecord(*it));
         }
-        return false;
+        for (QSet<GraphNode*>::const_iterator it = removing.constBegin(); it != removing.constEnd(); ++it)
+        {
+            JournalNode record;
+            record.m_id = (*it)->id();
+            record.m_record = Subgraph::recordNode(*it);
+            entry.m_removedNodes.push_back(record);
+        }
+        m_journal->record(entry);
     }
-    return false;
+
+    for (QSet<NodeSocket*>::const_iterator it = survivors.constBegin(); it != survivors.constEnd(); ++it)
+    {
+        (*it)->removeEdgeReferences(edges);
+    }
+
+    beginBatch();
+    for (QSet<GraphEdge*>::const_iterator it = edges.constBegin(); it != edges.constEnd(); ++it)
+    {
+        removeFromScene(*it);
+        delete *it;
+    }
+    for (QSet<GraphNode*>::const_iterator it = removing.constBegin(); it != removing.constEnd(); ++it)
+    {
+        removeFromScene(*it);
+        delete *it;
+    }
+
+    // compact the node list in a single pass
+    int kept = 0;
+    for (int i = 0; i < m_numNodesInScene; i++)
+    {
+        if (!removing.contains(m_nodesInScene->at(i)))
+        {
+            m_nodesInScene->at(kept) = m_nodesInScene->at(i);
+            kept++;
+        }
+    }
+    m_numNodesInScene = kept;
+    m_nodesInScene->resize(m_numNodesInScene);
+    endBatch();
+
+    return removing.size();
 }
 
 void GraphScene::removeAllNodes()
 {
-//    // need to copy across the number of nodes as m_numNodesInScene is modified
-    int controlCount = m_numNodesInScene-1;
+    // copy the list as it is compacted during removal
+    std::vector<GraphNode*> nodes(*m_nodesInScene);
+    removeNodes(nodes);
+}
 
-    for (int i = controlCount; i > -1; i--)
+void GraphScene::beginBatch()
+{
+    m_batchDepth++;
+}
+
+void GraphScene::endBatch()
+{
+    if (m_batchDepth > 0)
     {
-        removeNode(m_nodesInScene->at(i));
+        m_batchDepth--;
     }
+    scheduleRepaint();
+}
+
+void GraphScene::scheduleRepaint()
+{
+    if (m_batchDepth == 0)
+    {
+        viewport()->update();
+    }
+}
+
+void GraphScene::raiseNode(GraphNode *_node)
+{
+    if (_node == NULL) return;
+
+    std::map<int, GraphNode*>::iterator found = m_zOrder.find(_node->zDepth());
+    if (found != m_zOrder.end() && found->second == _node)
+    {
+        // already on top, nothing to do
+        if (found->first == m_zOrder.rbegin()->first) return;
+        m_zOrder.erase(found);
+    }
+
+    if (m_nextZDepth == INT_MAX)
+    {
+        compactZOrder();
+    }
+    _node->setZDepth(m_nextZDepth);
+    m_zOrder[m_nextZDepth] = _node;
+    m_nextZDepth++;
+}
+
+void GraphScene::compactZOrder()
+{
+    std::map<int, GraphNode*> compacted;
+    int depth = 0;
+    for (std::map<int, GraphNode*>::iterator it = m_zOrder.begin(); it != m_zOrder.end(); ++it)
+    {
+        it->second->setZDepth(depth);
+        compacted[depth] = it->second;
+        depth++;
+    }
+    m_zOrder.swap(compacted);
+    m_nextZDepth = depth;
+}
+
+void GraphScene::undo()
+{
+    m_activeInboundSocket = NULL;
+    m_activeOutboundSocket = NULL;
+    m_journal->undo();
+}
+
+void GraphScene::redo()
+{
+    m_activeInboundSocket = NULL;
+    m_activeOutboundSocket = NULL;
+    m_journal->redo();
+}
+
+void GraphScene::setUndoBudget(qint64 _bytes)
+{
+    m_journal->setByteBudget(_bytes);
+}
+
+GraphNode *GraphScene::nodeById(quint32 _id)
+{
+    return m_nodeIds.value(_id,NULL);
+}
+
+void GraphScene::nodeRenamed(GraphNode *_node, const std::string &_oldName, const std::string &_oldShortName)
+{
+    m_dataflow.nodeChanged(_node);
+    m_mirror.nodeChanged(_node);
+    m_changes->nodeRenamed(_node);
+    if (!m_journal->recording() || nodeById(_node->id()) != _node) return;
+
+    JournalRename rename;
+    rename.m_id = _node->id();
+    rename.m_oldName = _oldName;
+    rename.m_newName = _node->name();
+    rename.m_oldShortName = _oldShortName;
+    rename.m_newShortName = _node->shortName();
+    m_journal->recordRename(rename);
+}
+
+GraphNode *GraphScene::restoreNode(const JournalNode &_node)
+{
+    const SubgraphNode &record = _node.m_record;
+    // the node takes back the id it had so later steps still refer to it
+    GraphNode *node = createNode(record.m_valueType,record.m_nodeType,record.m_point,this,
+                                 record.m_numInbound,record.m_numOutbound,record.m_editable,record.m_deletable,
+                                 _node.m_id);
+    node->setBaseWidth(record.m_baseWidth);
+    node->setWidth(record.m_width);
+    node->setName(record.m_name);
+    node->setShortName(record.m_shortName);
+    return node;
+}
+
+int GraphScene::removeNodesById(const std::vector<quint32> &_ids)
+{
+    std::vector<GraphNode*> nodes;
+    for (int i = 0; i < int(_ids.size()); i++)
+    {
+        GraphNode *node = nodeById(_ids.at(i));
+        if (node)
+        {
+            nodes.push_back(node);
+        }
+    }
+    return removeNodes(nodes);
+}
+
+bool GraphScene::connectById(const JournalEdge &_edge)
+{
+    GraphNode *source = nodeById(_edge.m_sourceNode);
+    GraphNode *destination = nodeById(_edge.m_destinationNode);
+    if (!source || !destination) return false;
+    if (_edge.m_sourceSocket >= source->numOutboundSockets() || _edge.m_destinationSocket >= destination->numInboundSockets()) return false;
+
+    return connectSockets(source->outboundSocket(_edge.m_sourceSocket),destination->inboundSocket(_edge.m_destinationSocket)) != NULL;
+}
+
+bool GraphScene::disconnectById(const JournalEdge &_edge)
+{
+    GraphNode *source = nodeById(_edge.m_sourceNode);
+    GraphNode *destination = nodeById(_edge.m_destinationNode);
+    if (!source || !destination) return false;
+    if (_edge.m_sourceSocket >= source->numOutboundSockets() || _edge.m_destinationSocket >= destination->numInboundSockets()) return false;
+
+    NodeSocket *socket = source->outboundSocket(_edge.m_sourceSocket);
+    NodeSocket *target = destination->inboundSocket(_edge.m_destinationSocket);
+    for (int i = 0; i < socket->numEdges(); i++)
+    {
+        if (socket->edge(i)->destinationSocket() == target)
+        {
+            return socket->removeEdge(socket->edge(i));
+        }
+    }
+    return false;
+}
+
+void GraphScene::moveNodeById(quint32 _id, QPointF _point)
+{
+    GraphNode *node = nodeById(_id);
+    if (node)
+    {
+        node->setPoint(_point);
+        node->updateSockets();
+    }
+}
+
+void GraphScene::renameNodeById(quint32 _id, const std::string &_name, const std::string &_shortName)
+{
+    GraphNode *node = nodeById(_id);
+    if (node)
+    {
+        node->setName(_name);
+        node->setShortName(_shortName);
+    }
+}
+
+JournalEdge GraphScene::edgeRecord(GraphEdge *_edge)
+{
+    JournalEdge record;
+    record.m_sourceNode = _edge->sourceNode()->id();
+    record.m_destinationNode = _edge->destinationNode()->id();
+    record.m_sourceSocket = quint16(_edge->sourceNode()->outboundSocketIndex(_edge->sourceSocket()));
+    record.m_destinationSocket = quint16(_edge->destinationNode()->inboundSocketIndex(_edge->destinationSocket()));
+    return record;
 }
 
 void GraphScene::activeNodeSelected(bool _select)
@@ -701,6 +1536,118 @@ void GraphScene::activeNodeSelected(bool _select)
         m_nodeSelected = _select;
         m_activeSelectedNode->setSelectedNode(_select);
         m_activeSelectedNode->update();
+        if (_select)
+        {
+            m_selection.insert(m_activeSelectedNode);
+        }
+        else
+        {
+            m_selection.remove(m_activeSelectedNode);
+        }
+    }
+}
+
+void GraphScene::clearSelection()
+{
+    for (QSet<GraphNode*>::const_iterator it = m_selection.constBegin(); it != m_selection.constEnd(); ++it)
+    {
+        (*it)->setSelectedNode(false);
+        (*it)->update();
+    }
+    m_selection.clear();
+    m_nodeSelected = false;
+}
+
+void GraphScene::selectNodesInRect(const QRectF &_rect)
+{
+    std::vector<GraphNode*> candidates;
+    m_nodeIndex.query(_rect,&candidates);
+    for (int i = 0; i < int(candidates.size()); i++)
+    {
+        GraphNode *node = candidates.at(i);
+        if (node->sceneBoundingRect().intersects(_rect))
+        {
+            node->setSelectedNode(true);
+            node->update();
+            m_selection.insert(node);
+        }
+    }
+}
+
+void GraphScene::beginDrag(GraphNode *_node)
+{
+    m_dragGroup.clear();
+    m_dragEdges.clear();
+
+    // dragging a selected node moves the whole selection with it
+    if (m_selection.contains(_node))
+    {
+        for (QSet<GraphNode*>::const_iterator it = m_selection.constBegin(); it != m_selection.constEnd(); ++it)
+        {
+            if (*it != _node)
+            {
+                m_dragGroup.push_back(*it);
+            }
+        }
+    }
+    m_dragGroup.push_back(_node);
+
+    m_dragStart.clear();
+    for (int i = 0; i < int(m_dragGroup.size()); i++)
+    {
+        m_dragStart.push_back(m_dragGroup.at(i)->getPoint());
+    }
+
+    // keep the relative stacking of the group but put all of it on top, the grabbed node uppermost
+    std::map<int, GraphNode*> ordered;
+    for (int i = 0; i < int(m_dragGroup.size()) - 1; i++)
+    {
+        ordered[m_dragGroup.at(i)->zDepth()] = m_dragGroup.at(i);
+    }
+    for (std::map<int, GraphNode*>::iterator it = ordered.begin(); it != ordered.end(); ++it)
+    {
+        raiseNode(it->second);
+    }
+    raiseNode(_node);
+
+    // an edge between two moving nodes would otherwise be updated twice per move
+    QSet<GraphEdge*> edges;
+    for (int i = 0; i < int(m_dragGroup.size()); i++)
+    {
+        GraphNode *node = m_dragGroup.at(i);
+        for (int j = 0; j < node->numInboundSockets(); j++)
+        {
+            for (int k = 0; k < node->inboundSocket(j)->numEdges(); k++)
+            {
+                edges.insert(node->inboundSocket(j)->edge(k));
+            }
+        }
+        for (int j = 0; j < node->numOutboundSockets(); j++)
+        {
+            for (int k = 0; k < node->outboundSocket(j)->numEdges(); k++)
+            {
+                edges.insert(node->outboundSocket(j)->edge(k));
+            }
+        }
+    }
+    for (QSet<GraphEdge*>::const_iterator it = edges.constBegin(); it != edges.constEnd(); ++it)
+    {
+        m_dragEdges.push_back(*it);
+    }
+}
+
+void GraphScene::moveDragGroup(QPointF _delta)
+{
+    if (_delta.isNull()) return;
+
+    // move every node first, then bring each affected edge up to date once
+    for (int i = 0; i < int(m_dragGroup.size()); i++)
+    {
+        m_dragGroup.at(i)->setPoint(m_dragGroup.at(i)->getPoint() + _delta);
+    }
+    for (int i = 0; i < int(m_dragEdges.size()); i++)
+    {
+        m_dragEdges.at(i)->updateEdge();
     }
 }
 
@@ -727,55 +1674,235 @@ bool GraphScene::findNodeIndex(GraphNode *_node, int *_index)
     return found;
 }
 
+void GraphScene::collectMovingItems(std::vector<QGraphicsItem*> *_items)
+{
+    for (int i = 0; i < int(m_dragGroup.size()); i++)
+    {
+        GraphNode *node = m_dragGroup.at(i);
+        _items->push_back(node);
+        for (int j = 0; j < node->numInboundSockets(); j++)
+        {
+            _items->push_back(node->inboundSocket(j));
+        }
+        for (int j = 0; j < node->numOutboundSockets(); j++)
+        {
+            _items->push_back(node->outboundSocket(j));
+        }
+    }
+    _items->insert(_items->end(),m_dragEdges.begin(),m_dragEdges.end());
+}
+
+void GraphScene::cacheStaticLayer()
+{
+    if (m_dragGroup.empty()) return;
+
+    std::vector<QGraphicsItem*> moving;
+    collectMovingItems(&moving);
+    m_staticLayer->build(moving);
+}
+
+void GraphScene::drawBackground(QPainter *painter, const QRectF &rect)
+{
+    QGraphicsView::drawBackground(painter,rect);
+    m_staticLayer->drawTiles(painter,rect);
+}
+
+void GraphScene::setCacheBudget(qint64 _bytes)
+{
+    m_cacheBudget->setBudget(_bytes);
+}
+
+qint64 GraphScene::cacheBudget() const
+{
+    return m_cacheBudget->budget();
+}
+
+qint64 GraphScene::cacheUsage() const
+{
+    return m_cacheBudget->usage();
+}
+
+void GraphScene::scrollContentsBy(int dx, int dy)
+{
+    QGraphicsView::scrollContentsBy(dx,dy);
+    viewChanged();
+}
+
+void GraphScene::viewChanged()
+{
+    updateMaterializedRegion();
+
+    // everything on screen counts as recently used and the zoom may call for a different cache mode
+    std::vector<GraphNode*> visible;
+    m_nodeIndex.query(mapToScene(viewport()->rect()).boundingRect(),&visible);
+    for (int i = 0; i < int(visible.size()); i++)
+    {
+        if (m_materializedNodes.contains(visible.at(i)))
+        {
+            m_cacheBudget->touch(visible.at(i));
+        }
+    }
+
+    // any cached tiles were rendered for the old view
+    if (m_moveNode)
+    {
+        cacheStaticLayer();
+    }
+}
+
+void GraphScene::updateMaterializedRegion()
+{
+    QRectF visible = mapToScene(viewport()->rect()).boundingRect();
+    if (m_materializedRegion.contains(visible)) return;
+
+    // keep half a viewport either side of what is visible so small pans do not stream items in and out
+    qreal marginX = visible.width()*0.5;
+    qreal marginY = visible.height()*0.5;
+    m_materializedRegion = visible.adjusted(-marginX,-marginY,marginX,marginY);
+
+    // sync against a copy as syncing changes the materialized sets
+    std::vector<GraphNode*> nodes;
+    for (QSet<GraphNode*>::const_iterator it = m_materializedNodes.constBegin(); it != m_materializedNodes.constEnd(); ++it)
+    {
+        nodes.push_back(*it);
+    }
+    m_nodeIndex.query(m_materializedRegion,&nodes);
+    for (int i = 0; i < int(nodes.size()); i++)
+    {
+        syncNode(nodes.at(i));
+    }
+
+    std::vector<GraphEdge*> edges;
+    for (QSet<GraphEdge*>::const_iterator it = m_materializedEdges.constBegin(); it != m_materializedEdges.constEnd(); ++it)
+    {
+        edges.push_back(*it);
+    }
+    m_edgeIndex.query(m_materializedRegion,&edges);
+    for (int i = 0; i < int(edges.size()); i++)
+    {
+        syncEdge(edges.at(i));
+    }
+
+    QRectF bounds = m_scene->sceneRect().united(m_nodeIndex.bounds());
+    if (bounds != m_scene->sceneRect())
+    {
+        m_scene->setSceneRect(bounds);
+    }
+}
+
+void GraphScene::syncNode(GraphNode *_node)
+{
+    bool inRegion = _node->sceneBoundingRect().intersects(m_materializedRegion);
+    bool shown = m_materializedNodes.contains(_node);
+
+    if (inRegion && !shown)
+    {
+        materializeNode(_node);
+    }
+    else if (!inRegion && shown)
+    {
+        dematerializeNode(_node);
+    }
+}
+
+void GraphScene::syncEdge(GraphEdge *_edge)
+{
+    bool inRegion = _edge->intersectsRect(m_materializedRegion);
+    bool shown = m_materializedEdges.contains(_edge);
+
+    if (inRegion && !shown)
+    {
+        m_scene->addItem(_edge);
+        m_materializedEdges.insert(_edge);
+    }
+    else if (!inRegion && shown)
+    {
+        m_scene->removeItem(_edge);
+        m_materializedEdges.remove(_edge);
+    }
+}
+
+void GraphScene::materializeNode(GraphNode *_node)
+{
+    m_materializedNodes.insert(_node);
+    m_scene->addItem(_node);
+    _node->showLabels();
+    m_cacheBudget->touch(_node);
+    for (int i = 0; i < _node->numInboundSockets(); i++)
+    {
+        m_scene->addItem(_node->inboundSocket(i));
+    }
+    for (int i = 0; i < _node->numOutboundSockets(); i++)
+    {
+        m_scene->addItem(_node->outboundSocket(i));
+    }
+}
+
+void GraphScene::dematerializeNode(GraphNode *_node)
+{
+    m_materializedNodes.remove(_node);
+    for (int i = 0; i < _node->numInboundSockets(); i++)
+    {
+        m_scene->removeItem(_node->inboundSocket(i));
+    }
+    for (int i = 0; i < _node->numOutboundSockets(); i++)
+    {
+        m_scene->removeItem(_node->outboundSocket(i));
+    }
+    m_scene->removeItem(_node);
+    _node->hideLabels();
+    m_cacheBudget->release(_node);
+}
+
 void GraphScene::populateNodeSelectionMenu()
 {
     m_nodeSelectMenu->addMenu(m_objectMenus);
-        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_ANGLE).c_str()));
-        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_DISTANCE).c_str()));
-        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_TIME).c_str()));
-        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_LAST).c_str()));
-        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_COMPOUND).c_str()));
-        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_ENUM).c_str()));
-        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_GENERIC).c_str()));
-        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_MATRIX).c_str()));
-        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_MESSAGE).c_str()));
-        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_BOOLEAN).c_str()));
-        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_ONEBYTE).c_str()));
-        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_ONECHAR).c_str()));
-        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_ONESHORT).c_str()));
-        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_TWOSHORT).c_str()));
-        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_THREESHORT).c_str()));
-        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_ONELONG).c_str()));
-        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_ONEINT).c_str()));
-        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_TWOLONG).c_str()));
-        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_TWOINT).c_str()));
-        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_THREELONG).c_str()));
-        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_THREEINT).c_str()));
-        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_ONEFLOAT).c_str()));
-        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_TWOFLOAT).c_str()));
-        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_THREEFLOAT).c_str()));
-        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_ONEDOUBLE).c_str()));
-        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_TWODOUBLE).c_str()));
-        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_THREEDOUBLE).c_str()));
-        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_FOURDOUBLE).c_str()));
-        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_ADDRESS).c_str()));
-        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_NUM_LAST).c_str()));
+        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_ANGLE).data()));
+        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_DISTANCE).data()));
+        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_TIME).data()));
+        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_LAST).data()));
+        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_COMPOUND).data()));
+        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_ENUM).data()));
+        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_GENERIC).data()));
+        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_MATRIX).data()));
+        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_MESSAGE).data()));
+        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_BOOLEAN).data()));
+        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_ONEBYTE).data()));
+        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_ONECHAR).data()));
+        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_ONESHORT).data()));
+        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_TWOSHORT).data()));
+        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_THREESHORT).data()));
+        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_ONELONG).data()));
+        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_ONEINT).data()));
+        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_TWOLONG).data()));
+        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_TWOINT).data()));
+        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_THREELONG).data()));
+        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_THREEINT).data()));
+        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_ONEFLOAT).data()));
+        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_TWOFLOAT).data()));
+        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_THREEFLOAT).data()));
+        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_ONEDOUBLE).data()));
+        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_TWODOUBLE).data()));
+        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_THREEDOUBLE).data()));
+        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_FOURDOUBLE).data()));
+        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_ADDRESS).data()));
+        m_objectMenuActions.push_back(m_objectMenus->addAction(GenUtils::nodeTypeToString(NT_OBJ_NUM_LAST).data()));
     m_nodeSelectMenu->addMenu(m_argumentMenus);
-        m_argumentMenuActions.push_back(m_argumentMenus->addAction(GenUtils::nodeTypeToString(NT_BOOLEAN).c_str()));
-        m_argumentMenuActions.push_back(m_argumentMenus->addAction(GenUtils::nodeTypeToString(NT_CHAR).c_str()));
-        m_argumentMenuActions.push_back(m_argumentMenus->addAction(GenUtils::nodeTypeToString(NT_DOUBLE).c_str()));
-        m_argumentMenuActions.push_back(m_argumentMenus->addAction(GenUtils::nodeTypeToString(NT_FLOAT).c_str()));
-        m_argumentMenuActions.push_back(m_argumentMenus->addAction(GenUtils::nodeTypeToString(NT_INT).c_str()));
-        m_argumentMenuActions.push_back(m_argumentMenus->addAction(GenUtils::nodeTypeToString(NT_STRING).c_str()));
+        m_argumentMenuActions.push_back(m_argumentMenus->addAction(GenUtils::nodeTypeToString(NT_BOOLEAN).data()));
+        m_argumentMenuActions.push_back(m_argumentMenus->addAction(GenUtils::nodeTypeToString(NT_CHAR).data()));
+        m_argumentMenuActions.push_back(m_argumentMenus->addAction(GenUtils::nodeTypeToString(NT_DOUBLE).data()));
+        m_argumentMenuActions.push_back(m_argumentMenus->addAction(GenUtils::nodeTypeToString(NT_FLOAT).data()));
+        m_argumentMenuActions.push_back(m_argumentMenus->addAction(GenUtils::nodeTypeToString(NT_INT).data()));
+        m_argumentMenuActions.push_back(m_argumentMenus->addAction(GenUtils::nodeTypeToString(NT_STRING).data()));
     m_nodeSelectMenu->addMenu(m_memberMenus);
-        m_memberMenuActions.push_back(m_memberMenus->addAction(GenUtils::nodeTypeToString(NT_BOOLEAN).c_str()));
-        m_memberMenuActions.push_back(m_memberMenus->addAction(GenUtils::nodeTypeToString(NT_CHAR).c_str()));
-        m_memberMenuActions.push_back(m_memberMenus->addAction(GenUtils::nodeTypeToString(NT_DOUBLE).c_str()));
-        m_memberMenuActions.push_back(m_memberMenus->addAction(GenUtils::nodeTypeToString(NT_FLOAT).c_str()));
-        m_memberMenuActions.push_back(m_memberMenus->addAction(GenUtils::nodeTypeToString(NT_INT).c_str()));
-        m_memberMenuActions.push_back(m_memberMenus->addAction(GenUtils::nodeTypeToString(NT_STRING).c_str()));
-        m_memberMenuActions.push_back(m_memberMenus->addAction(GenUtils::nodeTypeToString(NT_VECTOR).c_str()));
-        m_memberMenuActions.push_back(m_memberMenus->addAction(GenUtils::nodeTypeToString(NT_MATRIX).c_str()));
+        m_memberMenuActions.push_back(m_memberMenus->addAction(GenUtils::nodeTypeToString(NT_BOOLEAN).data()));
+        m_memberMenuActions.push_back(m_memberMenus->addAction(GenUtils::nodeTypeToString(NT_CHAR).data()));
+        m_memberMenuActions.push_back(m_memberMenus->addAction(GenUtils::nodeTypeToString(NT_DOUBLE).data()));
+        m_memberMenuActions.push_back(m_memberMenus->addAction(GenUtils::nodeTypeToString(NT_FLOAT).data()));
+        m_memberMenuActions.push_back(m_memberMenus->addAction(GenUtils::nodeTypeToString(NT_INT).data()));
+        m_memberMenuActions.push_back(m_memberMenus->addAction(GenUtils::nodeTypeToString(NT_STRING).data()));
+        m_memberMenuActions.push_back(m_memberMenus->addAction(GenUtils::nodeTypeToString(NT_VECTOR).data()));
+        m_memberMenuActions.push_back(m_memberMenus->addAction(GenUtils::nodeTypeToString(NT_MATRIX).data()));
 
     QSignalMapper *objMapper = new QSignalMapper(this);
     QSignalMapper *argMapper = new QSignalMapper(this);
@@ -887,3 +2014,8 @@ void GraphScene::showNodeMenu(const QPoint &_pos)
     m_createNodeAt = mapToScene(_pos);
     m_nodeSelectMenu->exec(global);
 }
+
+void GraphScene::staticLayerReady()
+{
+    viewport()->update();
+}
@@ -0,0 +1,185 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "GraphSnapshot.h"
+#include "GraphExport.h"
+#include "NodeSocket.h"
+
+#include <algorithm>
+#include <utility>
+
+ExportResult GraphSnapshot::exportGraph() const
+{
+    // the used slots in the order their nodes were added, which is the order the scene holds them in
+    std::vector<std::pair<quint64, int> > used;
+    used.reserve(m_numNodes);
+    for (int c = 0; c < m_chunks.size(); c++)
+    {
+        const QVector<SnapshotNode> &chunk = m_chunks.at(c);
+        for (int i = 0; i < chunk.size(); i++)
+        {
+            if (chunk.at(i).m_used)
+            {
+                used.push_back(std::make_pair(chunk.at(i).m_sequence,(c << SNAPSHOT_CHUNK_SHIFT) + i));
+            }
+        }
+    }
+    std::sort(used.begin(),used.end());
+
+    // number the nodes in that order then turn the inputs into edges between them
+    std::vector<SubgraphNode> nodes;
+    std::vector<int> indices(m_chunks.size() << SNAPSHOT_CHUNK_SHIFT,-1);
+    nodes.reserve(used.size());
+    for (int i = 0; i < int(used.size()); i++)
+    {
+        int slot = used.at(i).second;
+        indices.at(slot) = int(nodes.size());
+        nodes.push_back(m_chunks.at(slot >> SNAPSHOT_CHUNK_SHIFT).at(slot & (SNAPSHOT_CHUNK_SIZE - 1)).m_record);
+    }
+
+    std::vector<SubgraphEdge> edges;
+    for (int i = 0; i < int(used.size()); i++)
+    {
+        int slot = used.at(i).second;
+        const std::vector<SnapshotInput> &inputs = m_chunks.at(slot >> SNAPSHOT_CHUNK_SHIFT).at(slot & (SNAPSHOT_CHUNK_SIZE - 1)).m_inputs;
+        for (int j = 0; j < int(inputs.size()); j++)
+        {
+            SubgraphEdge edge;
+            edge.m_sourceNode = indices.at(inputs.at(j).m_sourceSlot);
+            edge.m_sourceSocket = inputs.at(j).m_sourceSocket;
+            edge.m_destinationNode = i;
+            edge.m_destinationSocket = inputs.at(j).m_destinationSocket;
+            if (edge.m_sourceNode >= 0)
+            {
+                edges.push_back(edge);
+            }
+        }
+    }
+
+    ExportResult result;
+    result.m_ok = GraphExport::exportRecords(nodes,edges,&result.m_string,&result.m_error,false);
+    return result;
+}
+
+GraphMirror::GraphMirror()
+{
+    m_numSlots = 0;
+    m_nextSequence = 0;
+}
+
+SnapshotNode &GraphMirror::writeSlot(int _slot)
+{
+    // the non const operators detach the outer and then the inner container if a snapshot shares them
+    return m_snapshot.m_chunks[_slot >> SNAPSHOT_CHUNK_SHIFT][_slot & (SNAPSHOT_CHUNK_SIZE - 1)];
+}
+
+void GraphMirror::addNode(GraphNode *_node)
+{
+    if (!_node || m_slots.contains(_node)) return;
+
+    int slot;
+    if (!m_freeSlots.empty())
+    {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+    else
+    {
+        slot = m_numSlots++;
+        if ((slot >> SNAPSHOT_CHUNK_SHIFT) >= m_snapshot.m_chunks.size())
+        {
+            m_snapshot.m_chunks.append(QVector<SnapshotNode>(SNAPSHOT_CHUNK_SIZE));
+        }
+    }
+
+    SnapshotNode &node = writeSlot(slot);
+    node.m_record = Subgraph::recordNode(_node);
+    node.m_inputs.clear();
+    node.m_sequence = m_nextSequence++;
+    node.m_used = true;
+    m_slots.insert(_node,slot);
+    m_snapshot.m_numNodes++;
+}
+
+void GraphMirror::removeNode(GraphNode *_node)
+{
+    if (!m_slots.contains(_node)) return;
+
+    // a later node in the same slot must not inherit edges the node fed
+    for (int i = 0; i < _node->numOutboundSockets(); i++)
+    {
+        NodeSocket *socket = _node->outboundSocket(i);
+        for (int j = 0; j < socket->numEdges(); j++)
+        {
+            removeEdge(socket->edge(j));
+        }
+    }
+
+    QHash<GraphNode*, int>::iterator found = m_slots.find(_node);
+    SnapshotNode &node = writeSlot(found.value());
+    node.m_used = false;
+    node.m_inputs.clear();
+    m_freeSlots.push_back(found.value());
+    m_slots.erase(found);
+    m_snapshot.m_numNodes--;
+}
+
+void GraphMirror::nodeChanged(GraphNode *_node)
+{
+    QHash<GraphNode*, int>::const_iterator found = m_slots.constFind(_node);
+    if (found == m_slots.constEnd()) return;
+    writeSlot(found.value()).m_record = Subgraph::recordNode(_node);
+}
+
+int GraphMirror::edgeSlots(GraphEdge *_edge, SnapshotInput *_input) const
+{
+    if (!_edge || !_edge->sourceSocket() || !_edge->destinationSocket()) return -1;
+    QHash<GraphNode*, int>::const_iterator source = m_slots.constFind(_edge->sourceNode());
+    QHash<GraphNode*, int>::const_iterator destination = m_slots.constFind(_edge->destinationNode());
+    if (source == m_slots.constEnd() || destination == m_slots.constEnd()) return -1;
+
+    _input->m_sourceSlot = source.value();
+    _input->m_sourceSocket = _edge->sourceNode()->outboundSocketIndex(_edge->sourceSocket());
+    _input->m_destinationSocket = _edge->destinationNode()->inboundSocketIndex(_edge->destinationSocket());
+    return destination.value();
+}
+
+void GraphMirror::addEdge(GraphEdge *_edge)
+{
+    SnapshotInput input;
+    int destination = edgeSlots(_edge,&input);
+    if (destination < 0) return;
+    writeSlot(destination).m_inputs.push_back(input);
+}
+
+void GraphMirror::removeEdge(GraphEdge *_edge)
+{
+    SnapshotInput input;
+    int destination = edgeSlots(_edge,&input);
+    if (destination < 0) return;
+
+    std::vector<SnapshotInput> &inputs = writeSlot(destination).m_inputs;
+    for (int i = 0; i < int(inputs.size()); i++)
+    {
+        if (inputs.at(i).m_sourceSlot == input.m_sourceSlot && inputs.at(i).m_sourceSocket == input.m_sourceSocket &&
+            inputs.at(i).m_destinationSocket == input.m_destinationSocket)
+        {
+            inputs.erase(inputs.begin() + i);
+            return;
+        }
+    }
+}
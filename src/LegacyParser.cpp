@@ -0,0 +1,74 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "LegacyParser.h"
+#include "ConnectionRules.h"
+#include "Utilities.h"
+
+#include <cstring>
+
+// marks the start and end of the attributes in the export, as in GraphScene::collectInformation
+#define LEGACY_MARKER "#_#;"
+#define LEGACY_MARKER_SIZE 4
+// value type, type, name, short name and the -- closing the record
+#define LEGACY_FIELDS 5
+
+bool LegacyParser::parse(std::string_view _export, std::vector<LegacyRecord> *_records, std::string *_error)
+{
+    if (_export.size() < 2 * LEGACY_MARKER_SIZE || _export.substr(0,LEGACY_MARKER_SIZE) != LEGACY_MARKER ||
+        _export.substr(_export.size() - LEGACY_MARKER_SIZE) != LEGACY_MARKER)
+    {
+        *_error = "the export is not enclosed in " LEGACY_MARKER;
+        return false;
+    }
+
+    const char *next = _export.data() + LEGACY_MARKER_SIZE;
+    const char *end = _export.data() + _export.size() - LEGACY_MARKER_SIZE;
+    // a guess of the shortest record, enough to stop the vector growing more than once or twice
+    _records->reserve(_records->size() + (end - next) / 24);
+
+    std::string_view fields[LEGACY_FIELDS];
+    while (next < end)
+    {
+        for (int i = 0; i < LEGACY_FIELDS; i++)
+        {
+            const char *semicolon = static_cast<const char*>(std::memchr(next,';',size_t(end - next)));
+            if (!semicolon)
+            {
+                *_error = "a record is cut short at offset "+std::to_string(next - _export.data());
+                return false;
+            }
+            fields[i] = std::string_view(next,size_t(semicolon - next));
+            next = semicolon + 1;
+        }
+
+        LegacyRecord record;
+        record.m_valueType = GenUtils::valueStringToType(fields[0]);
+        record.m_nodeType = GenUtils::nodeStringToType(fields[1]);
+        record.m_name = fields[2];
+        record.m_shortName = fields[3];
+        // only pairs the menus can create, never the end node or an object with an argument's type
+        if (fields[4] != "--" || !ConnectionRules::offered(record.m_valueType,record.m_nodeType))
+        {
+            *_error = "unknown record '"+std::string(fields[0])+";"+std::string(fields[1])+";' before offset "+
+                      std::to_string(next - _export.data());
+            return false;
+        }
+        _records->push_back(record);
+    }
+    return true;
+}
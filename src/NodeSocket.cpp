@@ -23,6 +23,7 @@
 #include "GraphScene.h"
 #include "GraphNode.h"
 #include "GraphEdge.h"
+#include "Port.h"
 
 #include <QPainter>
 #include <QStyleOptionGraphicsItem>
@@ -59,6 +60,7 @@ NodeSocket::~NodeSocket()
     // now there are no edges left on this socket, delete it and remove itself from the scene
     m_edges->clear();
     delete m_edges;
+    delete m_port;
 
     m_parentNode = NULL;
 }
@@ -66,6 +68,8 @@ NodeSocket::~NodeSocket()
 void NodeSocket::init()
 {
     m_parentNode = NULL;
+    m_parentScene = NULL;
+    m_port = NULL;
 
     m_edges = new std::vector<GraphEdge*>;
     m_edges->clear();
@@ -84,6 +88,7 @@ void NodeSocket::addEdge(NodeSocket *_dest)
         GraphEdge *temp = new GraphEdge(this,_dest);
         m_edges->push_back(temp);
         m_numEdges++;
+        m_peers.insert(_dest);
         _dest->addEdgeReference(temp);
         // now need to add this edge to the scene
         m_parentScene->addEdgeToScene(temp);
@@ -94,6 +99,7 @@ void NodeSocket::addEdgeReference(GraphEdge *_edge)
 {
     m_edges->push_back(_edge);
     m_numEdges++;
+    m_peers.insert(peerOf(_edge));
 }
 
 void NodeSocket::updateEdges()
@@ -121,6 +127,7 @@ bool NodeSocket::removeEdge(GraphEdge *_edge)
     {
         return false;
     }
+    m_peers.remove(other);
 
     // if found then we need to remove it, tell the other socket this edge is connected to to remove the reference to it
     // and then condense the edge list back down so it does not include this edge
@@ -158,6 +165,7 @@ bool NodeSocket::removeEdgeReference(GraphEdge *_edge)
         }
         m_numEdges--;
         m_edges->resize(m_numEdges);
+        m_peers.remove(peerOf(_edge));
         return true;
     }
     return false;
@@ -174,6 +182,47 @@ void NodeSocket::removeAllEdges()
     }
 }
 
+void NodeSocket::removeEdgeReferences(const QSet<GraphEdge*> &_edges)
+{
+    // compact the edge list in place keeping only the edges not in the set
+    int kept = 0;
+    for (int i = 0; i < m_numEdges; i++)
+    {
+        if (!_edges.contains(m_edges->at(i)))
+        {
+            m_edges->at(kept) = m_edges->at(i);
+            kept++;
+        }
+        else
+        {
+            m_peers.remove(peerOf(m_edges->at(i)));
+        }
+    }
+    m_numEdges = kept;
+    m_edges->resize(m_numEdges);
+}
+
+void NodeSocket::clearEdgeReferences()
+{
+    m_edges->clear();
+    m_numEdges = 0;
+    m_peers.clear();
+}
+
+void NodeSocket::setPort(PortBase *_port)
+{
+    if (_port != m_port)
+    {
+        delete m_port;
+        m_port = _port;
+    }
+}
+
+NodeSocket *NodeSocket::peerOf(GraphEdge *_edge)
+{
+    return m_socketType == SK_INBOUND ? _edge->sourceSocket() : _edge->destinationSocket();
+}
+
 bool NodeSocket::socketOverPoint(QPointF _point)
 {
     // call the other node over point implementation
@@ -296,44 +345,6 @@ void NodeSocket::printSocketInfo()
     std::cout<<"\n------------------------------------------------------------------------------------------"<<std::endl;
 }
 
-bool NodeSocket::getConnectedNodeDetails(std::vector<std::string> *_vec)
-{
-    // return a vector to be able to detect if there are empty fields and any duplications
-    std::vector<std::string> returnString;
-    returnString.clear();
-
-    GraphNode* other;
-
-    for (int i = 0; i < m_numEdges; i++)
-    {
-        switch(m_socketType)
-        {
-            case(SK_INBOUND):
-            {
-                other = m_edges->at(i)->sourceNode();
-            }break;
-            case(SK_OUTBOUND):
-            {
-                other = m_edges->at(i)->destinationNode();
-            }break;
-        }
-        if (GenUtils::nodeTypeToString(other->nodeType()) == "" || other->name() == "" || other->shortName() == "")
-        {
-            return false;
-        }
-        returnString.push_back(std::string(GenUtils::valueTypeToString(other->valueType())+";"));
-        returnString.push_back(std::string(GenUtils::nodeTypeToString(other->nodeType())+";"));
-        returnString.push_back(std::string(other->name()+";"));
-        returnString.push_back(std::string(other->shortName()+";"));
-        returnString.push_back("--;"); // escape character for me to see where one edge ends and another begins
-    }
-    for (int j = 0; j < int(returnString.size()); j++)
-    {
-        _vec->push_back(returnString.at(j));
-    }
-    return true;
-}
-
 bool NodeSocket::findEdgeIndex(GraphEdge *_edge, int *_index)
 {
     int indexToRemove = 0;
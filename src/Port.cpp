@@ -0,0 +1,120 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Port.h"
+#include "NodeSocket.h"
+#include "GraphEdge.h"
+
+// integer and floating point ports rank by how much they can hold
+static int numericRank(PORT_TYPE _type)
+{
+    switch (_type)
+    {
+        case(PT_INT): return 1;
+        case(PT_FLOAT): return 2;
+        case(PT_DOUBLE): return 3;
+        default: return 0;
+    }
+}
+
+bool PortBase::accepts(const PortBase *_source) const
+{
+    if (!_source) return false;
+    if (m_type == PT_ANY || _source->type() == m_type) return true;
+
+    // a number may widen but never narrow
+    int from = numericRank(_source->type());
+    int to = numericRank(m_type);
+    return from > 0 && to > 0 && from <= to;
+}
+
+int PortBase::numInputs() const
+{
+    return m_socket ? m_socket->numEdges() : 0;
+}
+
+PortBase *PortBase::inputPort(int _index) const
+{
+    if (_index < 0 || _index >= numInputs()) return NULL;
+    GraphEdge *edge = m_socket->edge(_index);
+    if (!edge || !edge->sourceSocket()) return NULL;
+    return edge->sourceSocket()->port();
+}
+
+PORT_TYPE PortTypes::forNode(NODE_TYPE _type)
+{
+    switch (_type)
+    {
+        case(NT_INT):
+        case(NT_OBJ_ONEBYTE):
+        case(NT_OBJ_ONESHORT):
+        case(NT_OBJ_ONELONG):
+        case(NT_OBJ_ONEINT):
+            return PT_INT;
+        case(NT_FLOAT):
+        case(NT_OBJ_ONEFLOAT):
+            return PT_FLOAT;
+        case(NT_DOUBLE):
+        case(NT_OBJ_ANGLE):
+        case(NT_OBJ_DISTANCE):
+        case(NT_OBJ_TIME):
+        case(NT_OBJ_ONEDOUBLE):
+            return PT_DOUBLE;
+        case(NT_BOOLEAN):
+        case(NT_OBJ_BOOLEAN):
+            return PT_BOOL;
+        case(NT_VECTOR):
+        case(NT_OBJ_TWOSHORT):
+        case(NT_OBJ_THREESHORT):
+        case(NT_OBJ_TWOLONG):
+        case(NT_OBJ_TWOINT):
+        case(NT_OBJ_THREELONG):
+        case(NT_OBJ_THREEINT):
+        case(NT_OBJ_TWOFLOAT):
+        case(NT_OBJ_THREEFLOAT):
+        case(NT_OBJ_TWODOUBLE):
+        case(NT_OBJ_THREEDOUBLE):
+        case(NT_OBJ_FOURDOUBLE):
+            return PT_VECTOR;
+        case(NT_MATRIX):
+        case(NT_OBJ_MATRIX):
+            return PT_MATRIX;
+        case(NT_ENDNODE):
+            return PT_ANY;
+        case(NT_NOTYPE):
+            return PT_NONE;
+        default:
+            // characters, enums, messages and the other attribute kinds travel as text
+            return PT_STRING;
+    }
+}
+
+PortBase *PortTypes::create(PORT_TYPE _type, NodeSocket *_socket)
+{
+    switch (_type)
+    {
+        case(PT_INT): return new Port<int>(_socket);
+        case(PT_FLOAT): return new Port<float>(_socket);
+        case(PT_DOUBLE): return new Port<double>(_socket);
+        case(PT_BOOL): return new Port<bool>(_socket);
+        case(PT_STRING): return new Port<std::string>(_socket);
+        case(PT_VECTOR): return new Port<PortVector>(_socket);
+        case(PT_MATRIX): return new Port<PortMatrix>(_socket);
+        case(PT_ANY): return new PortBase(PT_ANY,_socket);
+        default: return NULL;
+    }
+}
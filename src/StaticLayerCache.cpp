@@ -0,0 +1,198 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "StaticLayerCache.h"
+
+#include <QGraphicsScene>
+#include <QPainter>
+#include <QPicture>
+#include <QtConcurrent>
+
+#define STATIC_TILE_SIZE 256
+
+// a single tile to render on a worker thread
+// each job carries its own copy of the recorded picture data so no painting state is shared between threads
+struct StaticTileJob
+{
+    QByteArray m_picture;
+    QRect m_rect;
+};
+
+static QImage renderStaticTile(const StaticTileJob &_job)
+{
+    QPicture picture;
+    picture.setData(_job.m_picture.constData(),_job.m_picture.size());
+
+    QImage tile(_job.m_rect.size(),QImage::Format_ARGB32_Premultiplied);
+    tile.fill(Qt::transparent);
+
+    QPainter painter(&tile);
+    painter.translate(-_job.m_rect.topLeft());
+    painter.setClipRect(_job.m_rect);
+    painter.drawPicture(0,0,picture);
+    painter.end();
+
+    return tile;
+}
+
+StaticLayerCache::StaticLayerCache(QGraphicsView *_view, QObject *_parent) : QObject(_parent)
+{
+    m_view = _view;
+    m_building = false;
+    m_active = false;
+
+    connect(&m_watcher,SIGNAL(finished()),this,SLOT(tilesFinished()));
+}
+
+StaticLayerCache::~StaticLayerCache()
+{
+    // only wait for the workers here, the items may already have been deleted by the scene
+    if (m_building)
+    {
+        m_watcher.cancel();
+        m_watcher.waitForFinished();
+    }
+}
+
+void StaticLayerCache::build(const std::vector<QGraphicsItem*> &_dynamicItems)
+{
+    release();
+
+    QGraphicsScene *scene = m_view->scene();
+    if (!scene) return;
+
+    QRect device = m_view->viewport()->rect();
+    if (device.isEmpty()) return;
+
+    QRectF source = m_view->mapToScene(device).boundingRect();
+    m_transform = m_view->viewportTransform();
+
+    QSet<QGraphicsItem*> dynamic;
+    std::vector<QGraphicsItem*> hiddenForRecord;
+    for (int i = 0; i < int(_dynamicItems.size()); i++)
+    {
+        dynamic.insert(_dynamicItems.at(i));
+        if (_dynamicItems.at(i)->isVisible())
+        {
+            _dynamicItems.at(i)->setVisible(false);
+            hiddenForRecord.push_back(_dynamicItems.at(i));
+        }
+    }
+
+    // record the static layer once on this thread, the workers then only replay the recording
+    QPicture picture;
+    QPainter recorder(&picture);
+    scene->render(&recorder,QRectF(device),source,Qt::IgnoreAspectRatio);
+    recorder.end();
+
+    for (int i = 0; i < int(hiddenForRecord.size()); i++)
+    {
+        hiddenForRecord.at(i)->setVisible(true);
+    }
+
+    // remember which top level items the tiles will stand in for, they are only hidden once the tiles are ready
+    QList<QGraphicsItem*> inView = scene->items(source,Qt::IntersectsItemBoundingRect);
+    for (int i = 0; i < inView.size(); i++)
+    {
+        QGraphicsItem *item = inView.at(i);
+        if (item->parentItem() == NULL && item->isVisible() && !dynamic.contains(item))
+        {
+            m_staticItems.push_back(item);
+        }
+    }
+
+    QByteArray recording(picture.data(),int(picture.size()));
+    QList<StaticTileJob> jobs;
+    for (int y = 0; y < device.height(); y += STATIC_TILE_SIZE)
+    {
+        for (int x = 0; x < device.width(); x += STATIC_TILE_SIZE)
+        {
+            StaticTileJob job;
+            job.m_picture = recording;
+            job.m_rect = QRect(x,y,qMin(STATIC_TILE_SIZE,device.width()-x),qMin(STATIC_TILE_SIZE,device.height()-y));
+            m_tileRects.push_back(job.m_rect);
+            jobs.append(job);
+        }
+    }
+
+    m_building = true;
+    m_watcher.setFuture(QtConcurrent::mapped(jobs,renderStaticTile));
+}
+
+void StaticLayerCache::release()
+{
+    if (m_building)
+    {
+        m_building = false;
+        m_watcher.cancel();
+        m_watcher.waitForFinished();
+    }
+
+    if (m_active)
+    {
+        for (int i = 0; i < int(m_staticItems.size()); i++)
+        {
+            m_staticItems.at(i)->setVisible(true);
+        }
+        m_active = false;
+    }
+
+    m_staticItems.clear();
+    m_tileRects.clear();
+    m_tiles.clear();
+}
+
+bool StaticLayerCache::active()
+{
+    return m_active && m_view->viewportTransform() == m_transform;
+}
+
+void StaticLayerCache::drawTiles(QPainter *_painter, const QRectF &_exposed)
+{
+    if (!active()) return;
+
+    QRect exposed = m_view->mapFromScene(_exposed).boundingRect();
+
+    // the tiles are in viewport pixels so draw them without the scene transform
+    _painter->save();
+    _painter->resetTransform();
+    for (int i = 0; i < int(m_tileRects.size()) && i < m_tiles.size(); i++)
+    {
+        if (m_tileRects.at(i).intersects(exposed))
+        {
+            _painter->drawImage(m_tileRects.at(i).topLeft(),m_tiles.at(i));
+        }
+    }
+    _painter->restore();
+}
+
+void StaticLayerCache::tilesFinished()
+{
+    // the cache may have been released while the workers were still running
+    if (!m_building || m_watcher.future().isCanceled()) return;
+
+    m_building = false;
+    m_tiles = m_watcher.future().results();
+
+    for (int i = 0; i < int(m_staticItems.size()); i++)
+    {
+        m_staticItems.at(i)->setVisible(false);
+    }
+    m_active = true;
+
+    emit ready();
+}
@@ -0,0 +1,265 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Subgraph.h"
+#include "NodeSocket.h"
+#include "GraphEdge.h"
+
+#include <QDataStream>
+#include <QFile>
+#include <QHash>
+
+// 'NGSG'
+#define SUBGRAPH_MAGIC 0x4E475347
+#define SUBGRAPH_VERSION 1
+
+#define FLAG_EDITABLE 0x1
+#define FLAG_DELETABLE 0x2
+
+Subgraph::Subgraph()
+{
+    m_origin = QPointF(0.0,0.0);
+}
+
+void Subgraph::capture(const std::vector<GraphNode*> &_nodes, bool _includeEnd)
+{
+    m_nodes.clear();
+    m_edges.clear();
+
+    // nodes are recorded in the order given so the same graph always gives the same file
+    std::vector<GraphNode*> captured;
+    QHash<GraphNode*, int> indices;
+    for (int i = 0; i < int(_nodes.size()); i++)
+    {
+        GraphNode *node = _nodes.at(i);
+        if ((node->endNode() && !_includeEnd) || indices.contains(node)) continue;
+
+        indices.insert(node,int(captured.size()));
+        if (captured.empty())
+        {
+            m_origin = node->getPoint();
+        }
+        else
+        {
+            m_origin.setX(qMin(m_origin.x(),node->getPoint().x()));
+            m_origin.setY(qMin(m_origin.y(),node->getPoint().y()));
+        }
+        captured.push_back(node);
+    }
+
+    m_nodes.reserve(captured.size());
+    for (int i = 0; i < int(captured.size()); i++)
+    {
+        m_nodes.push_back(recordNode(captured.at(i),m_origin));
+    }
+
+    // walking the inbound sockets visits each edge once, and keeps the order the edges were attached to each
+    // destination in, which is the order the scene exports its inputs in
+    for (int i = 0; i < int(captured.size()); i++)
+    {
+        GraphNode *node = captured.at(i);
+        for (int s = 0; s < node->numInboundSockets(); s++)
+        {
+            NodeSocket *socket = node->inboundSocket(s);
+            for (int e = 0; e < socket->numEdges(); e++)
+            {
+                GraphEdge *edge = socket->edge(e);
+                NodeSocket *source = edge->sourceSocket();
+                GraphNode *sourceNode = source->getParentNode();
+                if (!indices.contains(sourceNode)) continue;
+
+                SubgraphEdge edgeRecord;
+                edgeRecord.m_sourceNode = indices.value(sourceNode);
+                edgeRecord.m_sourceSocket = sourceNode->outboundSocketIndex(source);
+                edgeRecord.m_destinationNode = i;
+                edgeRecord.m_destinationSocket = s;
+                m_edges.push_back(edgeRecord);
+            }
+        }
+    }
+}
+
+SubgraphNode Subgraph::recordNode(GraphNode *_node, QPointF _origin)
+{
+    SubgraphNode record;
+    record.m_valueType = _node->valueType();
+    record.m_nodeType = _node->nodeType();
+    record.m_point = _node->getPoint() - _origin;
+    record.m_width = _node->getWidth();
+    record.m_baseWidth = _node->getBaseWidth();
+    record.m_editable = _node->editable();
+    record.m_deletable = _node->deletable();
+    record.m_numInbound = _node->numInboundSockets();
+    record.m_numOutbound = _node->numOutboundSockets();
+    record.m_name = _node->name();
+    record.m_shortName = _node->shortName();
+    return record;
+}
+
+QByteArray Subgraph::encode() const
+{
+    QByteArray data;
+    QDataStream stream(&data,QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    stream << quint32(SUBGRAPH_MAGIC) << quint16(SUBGRAPH_VERSION);
+    stream << quint32(m_nodes.size());
+    for (int i = 0; i < int(m_nodes.size()); i++)
+    {
+        const SubgraphNode &node = m_nodes.at(i);
+        quint8 flags = 0;
+        if (node.m_editable) flags |= FLAG_EDITABLE;
+        if (node.m_deletable) flags |= FLAG_DELETABLE;
+
+        stream << quint8(node.m_valueType) << quint16(node.m_nodeType)
+               << float(node.m_point.x()) << float(node.m_point.y())
+               << float(node.m_width) << float(node.m_baseWidth)
+               << flags << quint8(node.m_numInbound) << quint8(node.m_numOutbound)
+               << QByteArray(node.m_name.c_str(),int(node.m_name.size()))
+               << QByteArray(node.m_shortName.c_str(),int(node.m_shortName.size()));
+    }
+
+    stream << quint32(m_edges.size());
+    for (int i = 0; i < int(m_edges.size()); i++)
+    {
+        const SubgraphEdge &edge = m_edges.at(i);
+        stream << quint32(edge.m_sourceNode) << quint8(edge.m_sourceSocket)
+               << quint32(edge.m_destinationNode) << quint8(edge.m_destinationSocket);
+    }
+    return data;
+}
+
+bool Subgraph::decode(const QByteArray &_data, bool _allowEnd)
+{
+    m_nodes.clear();
+    m_edges.clear();
+    m_origin = QPointF(0.0,0.0);
+
+    QDataStream stream(_data);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    stream >> magic >> version;
+    if (magic != SUBGRAPH_MAGIC || version != SUBGRAPH_VERSION) return false;
+
+    quint32 numNodes = 0;
+    stream >> numNodes;
+    bool foundEnd = false;
+    for (quint32 i = 0; i < numNodes && stream.status() == QDataStream::Ok; i++)
+    {
+        quint8 valueType, flags, numInbound, numOutbound;
+        quint16 nodeType;
+        float x, y, width, baseWidth;
+        QByteArray name, shortName;
+        stream >> valueType >> nodeType >> x >> y >> width >> baseWidth
+               >> flags >> numInbound >> numOutbound >> name >> shortName;
+
+        // types outside the enums would be cast into values nothing handles, and a pasted end node would be a second one
+        bool endNode = valueType == VT_END && nodeType == NT_ENDNODE;
+        bool validTypes = valueType >= 1 && valueType < VT_END && nodeType >= 1 && nodeType < NT_ENDNODE;
+        if (endNode && (!_allowEnd || foundEnd))
+        {
+            stream.setStatus(QDataStream::ReadCorruptData);
+            break;
+        }
+        if (!endNode && !validTypes)
+        {
+            stream.setStatus(QDataStream::ReadCorruptData);
+            break;
+        }
+        foundEnd = foundEnd || endNode;
+
+        SubgraphNode node;
+        node.m_valueType = VALUE_TYPE(valueType);
+        node.m_nodeType = NODE_TYPE(nodeType);
+        node.m_point = QPointF(x,y);
+        node.m_width = width;
+        node.m_baseWidth = baseWidth;
+        node.m_editable = flags & FLAG_EDITABLE;
+        node.m_deletable = flags & FLAG_DELETABLE;
+        node.m_numInbound = numInbound;
+        node.m_numOutbound = numOutbound;
+        node.m_name = std::string(name.constData(),name.size());
+        node.m_shortName = std::string(shortName.constData(),shortName.size());
+        m_nodes.push_back(node);
+    }
+
+    quint32 numEdges = 0;
+    stream >> numEdges;
+    for (quint32 i = 0; i < numEdges && stream.status() == QDataStream::Ok; i++)
+    {
+        quint32 sourceNode, destinationNode;
+        quint8 sourceSocket, destinationSocket;
+        stream >> sourceNode >> sourceSocket >> destinationNode >> destinationSocket;
+
+        // reject anything pointing outside the subgraph rather than trusting data from another process
+        if (sourceNode >= m_nodes.size() || destinationNode >= m_nodes.size() ||
+            sourceSocket >= m_nodes.at(sourceNode).m_numOutbound ||
+            destinationSocket >= m_nodes.at(destinationNode).m_numInbound)
+        {
+            stream.setStatus(QDataStream::ReadCorruptData);
+            break;
+        }
+
+        SubgraphEdge edge;
+        edge.m_sourceNode = int(sourceNode);
+        edge.m_sourceSocket = sourceSocket;
+        edge.m_destinationNode = int(destinationNode);
+        edge.m_destinationSocket = destinationSocket;
+        m_edges.push_back(edge);
+    }
+
+    if (stream.status() != QDataStream::Ok)
+    {
+        m_nodes.clear();
+        m_edges.clear();
+        return false;
+    }
+    return true;
+}
+
+QMimeData *Subgraph::toMimeData() const
+{
+    QMimeData *mime = new QMimeData();
+    mime->setData(SUBGRAPH_MIME_TYPE,encode());
+    return mime;
+}
+
+bool Subgraph::fromMimeData(const QMimeData *_mime)
+{
+    if (!_mime || !_mime->hasFormat(SUBGRAPH_MIME_TYPE)) return false;
+    return decode(_mime->data(SUBGRAPH_MIME_TYPE));
+}
+
+bool Subgraph::save(const QString &_fileName) const
+{
+    QFile file(_fileName);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    QByteArray data = encode();
+    return file.write(data) == data.size();
+}
+
+bool Subgraph::load(const QString &_fileName)
+{
+    QFile file(_fileName);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    // a saved graph holds its end node
+    return decode(file.readAll(),true);
+}
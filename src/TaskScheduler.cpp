@@ -0,0 +1,259 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TaskScheduler.h"
+
+#include <QThread>
+#include <QMutexLocker>
+
+// a thread that runs the scheduler's worker loop until told to stop
+class TaskWorker : public QThread
+{
+public:
+    TaskWorker(TaskScheduler *_scheduler, int _index) : m_scheduler(_scheduler), m_index(_index) {}
+
+protected:
+    void run() {m_scheduler->workerLoop(m_index);}
+
+private:
+    TaskScheduler *m_scheduler;
+    int m_index;
+};
+
+TaskScheduler::TaskScheduler(int _threads)
+{
+    m_quit = false;
+
+    int threads = _threads > 0 ? _threads : QThread::idealThreadCount();
+    if (threads < 1)
+    {
+        threads = 1;
+    }
+
+    for (int i = 0; i < threads; i++)
+    {
+        m_queues.push_back(new Queue);
+    }
+    // a single worker would only add a thread switch to running the tasks in order
+    if (threads > 1)
+    {
+        for (int i = 0; i < threads; i++)
+        {
+            m_workers.push_back(new TaskWorker(this,i));
+            m_workers.back()->start();
+        }
+    }
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    m_lock.lock();
+    m_quit = true;
+    m_wake.wakeAll();
+    m_lock.unlock();
+
+    for (int i = 0; i < int(m_workers.size()); i++)
+    {
+        m_workers.at(i)->wait();
+        delete m_workers.at(i);
+    }
+    for (int i = 0; i < int(m_queues.size()); i++)
+    {
+        delete m_queues.at(i);
+    }
+}
+
+int TaskScheduler::addTask(QRunnable *_task)
+{
+    m_entries.push_back(Entry());
+    m_entries.back().m_task = _task;
+    m_entries.back().m_waiting.store(0);
+    return int(m_entries.size()) - 1;
+}
+
+void TaskScheduler::addDependency(int _task, int _dependency)
+{
+    m_entries.at(_dependency).m_dependents.push_back(_task);
+    m_entries.at(_task).m_waiting.fetchAndAddRelaxed(1);
+}
+
+void TaskScheduler::execute()
+{
+    if (m_entries.empty()) return;
+
+    m_stolen.store(0);
+    if (m_workers.empty())
+    {
+        executeSerial();
+        m_entries.clear();
+        return;
+    }
+
+    m_remaining.store(int(m_entries.size()));
+
+    // find the tasks that are ready straight away before queueing any, once queued they may finish and make
+    // more tasks ready while we are still looking
+    std::vector<int> ready;
+    for (int i = 0; i < int(m_entries.size()); i++)
+    {
+        if (m_entries.at(i).m_waiting.load() == 0)
+        {
+            ready.push_back(i);
+        }
+    }
+
+    // spread them over the workers
+    for (int i = 0; i < int(ready.size()); i++)
+    {
+        Queue *queue = m_queues.at(i % int(m_queues.size()));
+        queue->m_mutex.lock();
+        queue->m_tasks.push_back(ready.at(i));
+        queue->m_mutex.unlock();
+        m_queued.fetchAndAddOrdered(1);
+    }
+
+    m_lock.lock();
+    m_wake.wakeAll();
+    while (m_remaining.load() > 0)
+    {
+        m_done.wait(&m_lock);
+    }
+    m_lock.unlock();
+
+    m_entries.clear();
+}
+
+void TaskScheduler::workerLoop(int _worker)
+{
+    for (;;)
+    {
+        int task = take(_worker);
+        if (task >= 0)
+        {
+            run(_worker,task);
+            continue;
+        }
+
+        // only sleep once nothing is queued anywhere, checked under the lock pushes wake through
+        QMutexLocker locker(&m_lock);
+        if (m_quit) return;
+        if (m_queued.load() == 0)
+        {
+            m_wake.wait(&m_lock);
+        }
+        if (m_quit) return;
+    }
+}
+
+void TaskScheduler::push(int _worker, int _task)
+{
+    Queue *queue = m_queues.at(_worker);
+    queue->m_mutex.lock();
+    queue->m_tasks.push_back(_task);
+    queue->m_mutex.unlock();
+    m_queued.fetchAndAddOrdered(1);
+
+    // this worker carries on with the task itself, wake one other in case there is more than it can do
+    m_lock.lock();
+    m_wake.wakeOne();
+    m_lock.unlock();
+}
+
+int TaskScheduler::take(int _worker)
+{
+    // newest first from our own queue
+    Queue *own = m_queues.at(_worker);
+    own->m_mutex.lock();
+    if (!own->m_tasks.empty())
+    {
+        int task = own->m_tasks.back();
+        own->m_tasks.pop_back();
+        own->m_mutex.unlock();
+        m_queued.fetchAndAddOrdered(-1);
+        return task;
+    }
+    own->m_mutex.unlock();
+
+    // oldest first from everyone else, starting with our neighbour so thieves spread out
+    int count = int(m_queues.size());
+    for (int i = 1; i < count; i++)
+    {
+        Queue *victim = m_queues.at((_worker + i) % count);
+        victim->m_mutex.lock();
+        if (!victim->m_tasks.empty())
+        {
+            int task = victim->m_tasks.front();
+            victim->m_tasks.pop_front();
+            victim->m_mutex.unlock();
+            m_queued.fetchAndAddOrdered(-1);
+            m_stolen.fetchAndAddRelaxed(1);
+            return task;
+        }
+        victim->m_mutex.unlock();
+    }
+    return -1;
+}
+
+void TaskScheduler::run(int _worker, int _task)
+{
+    Entry &entry = m_entries.at(_task);
+    entry.m_task->run();
+
+    for (int i = 0; i < int(entry.m_dependents.size()); i++)
+    {
+        int dependent = entry.m_dependents.at(i);
+        if (m_entries.at(dependent).m_waiting.fetchAndAddOrdered(-1) == 1)
+        {
+            push(_worker,dependent);
+        }
+    }
+
+    if (m_remaining.fetchAndAddOrdered(-1) == 1)
+    {
+        QMutexLocker locker(&m_lock);
+        m_done.wakeAll();
+    }
+}
+
+void TaskScheduler::executeSerial()
+{
+    // Kahn's algorithm on the calling thread
+    std::deque<int> ready;
+    for (int i = 0; i < int(m_entries.size()); i++)
+    {
+        if (m_entries.at(i).m_waiting.load() == 0)
+        {
+            ready.push_back(i);
+        }
+    }
+
+    while (!ready.empty())
+    {
+        Entry &entry = m_entries.at(ready.front());
+        ready.pop_front();
+        entry.m_task->run();
+
+        for (int i = 0; i < int(entry.m_dependents.size()); i++)
+        {
+            int dependent = entry.m_dependents.at(i);
+            if (m_entries.at(dependent).m_waiting.fetchAndAddRelaxed(-1) == 1)
+            {
+                ready.push_back(dependent);
+            }
+        }
+    }
+}
@@ -0,0 +1,214 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TopologicalOrder.h"
+#include "NodeSocket.h"
+#include "GraphEdge.h"
+
+#include <QSet>
+
+#include <algorithm>
+
+// below this many holes the order is never compacted
+#define MIN_HOLES_TO_COMPACT 64
+
+// orders nodes by their position in a TopologicalOrder
+struct IndexLess
+{
+    const QHash<GraphNode*, int> *m_index;
+    bool operator()(GraphNode *_a, GraphNode *_b) const {return m_index->value(_a) < m_index->value(_b);}
+};
+
+TopologicalOrder::TopologicalOrder()
+{
+    m_holes = 0;
+}
+
+void TopologicalOrder::addNode(GraphNode *_node)
+{
+    if (m_index.contains(_node)) return;
+
+    m_index.insert(_node,int(m_order.size()));
+    m_order.push_back(_node);
+}
+
+void TopologicalOrder::removeNode(GraphNode *_node)
+{
+    QHash<GraphNode*, int>::iterator found = m_index.find(_node);
+    if (found == m_index.end()) return;
+
+    m_order.at(found.value()) = NULL;
+    m_index.erase(found);
+    m_holes++;
+
+    if (m_holes > MIN_HOLES_TO_COMPACT && m_holes > int(m_order.size()) / 2)
+    {
+        compact();
+    }
+}
+
+bool TopologicalOrder::canConnect(GraphNode *_from, GraphNode *_to)
+{
+    if (_from == _to) return false;
+
+    int upper = index(_from);
+    int lower = index(_to);
+    if (upper < 0 || lower < 0) return false;
+    // already in order so no path can lead back
+    if (lower > upper) return true;
+
+    std::vector<GraphNode*> reached;
+    return searchForward(_to,upper,&reached);
+}
+
+bool TopologicalOrder::connect(GraphNode *_from, GraphNode *_to)
+{
+    if (_from == _to) return false;
+
+    int upper = index(_from);
+    int lower = index(_to);
+    if (upper < 0 || lower < 0) return false;
+    if (lower > upper) return true;
+
+    // only the nodes positioned between the two ends can be affected
+    std::vector<GraphNode*> forward;
+    if (!searchForward(_to,upper,&forward)) return false;
+    std::vector<GraphNode*> backward;
+    searchBackward(_from,lower,&backward);
+
+    sortByIndex(&forward);
+    sortByIndex(&backward);
+
+    // reuse the positions the affected nodes already hold, handing the lowest to the nodes that lead to the source
+    std::vector<int> positions;
+    for (int i = 0; i < int(backward.size()); i++)
+    {
+        positions.push_back(m_index.value(backward.at(i)));
+    }
+    for (int i = 0; i < int(forward.size()); i++)
+    {
+        positions.push_back(m_index.value(forward.at(i)));
+    }
+    std::sort(positions.begin(),positions.end());
+
+    int next = 0;
+    for (int i = 0; i < int(backward.size()); i++, next++)
+    {
+        m_index[backward.at(i)] = positions.at(next);
+        m_order.at(positions.at(next)) = backward.at(i);
+    }
+    for (int i = 0; i < int(forward.size()); i++, next++)
+    {
+        m_index[forward.at(i)] = positions.at(next);
+        m_order.at(positions.at(next)) = forward.at(i);
+    }
+    return true;
+}
+
+std::vector<GraphNode*> TopologicalOrder::order() const
+{
+    std::vector<GraphNode*> nodes;
+    nodes.reserve(m_index.size());
+    for (int i = 0; i < int(m_order.size()); i++)
+    {
+        if (m_order.at(i))
+        {
+            nodes.push_back(m_order.at(i));
+        }
+    }
+    return nodes;
+}
+
+bool TopologicalOrder::searchForward(GraphNode *_start, int _upper, std::vector<GraphNode*> *_found)
+{
+    QSet<GraphNode*> visited;
+    std::vector<GraphNode*> stack;
+    stack.push_back(_start);
+    visited.insert(_start);
+
+    while (!stack.empty())
+    {
+        GraphNode *node = stack.back();
+        stack.pop_back();
+        _found->push_back(node);
+
+        for (int i = 0; i < node->numOutboundSockets(); i++)
+        {
+            NodeSocket *socket = node->outboundSocket(i);
+            for (int j = 0; j < socket->numEdges(); j++)
+            {
+                GraphNode *next = socket->edge(j)->destinationNode();
+                int position = index(next);
+                // reaching the source of the new edge means it would close a cycle
+                if (position == _upper) return false;
+                if (position < _upper && !visited.contains(next))
+                {
+                    visited.insert(next);
+                    stack.push_back(next);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void TopologicalOrder::searchBackward(GraphNode *_start, int _lower, std::vector<GraphNode*> *_found)
+{
+    QSet<GraphNode*> visited;
+    std::vector<GraphNode*> stack;
+    stack.push_back(_start);
+    visited.insert(_start);
+
+    while (!stack.empty())
+    {
+        GraphNode *node = stack.back();
+        stack.pop_back();
+        _found->push_back(node);
+
+        for (int i = 0; i < node->numInboundSockets(); i++)
+        {
+            NodeSocket *socket = node->inboundSocket(i);
+            for (int j = 0; j < socket->numEdges(); j++)
+            {
+                GraphNode *previous = socket->edge(j)->sourceNode();
+                if (index(previous) > _lower && !visited.contains(previous))
+                {
+                    visited.insert(previous);
+                    stack.push_back(previous);
+                }
+            }
+        }
+    }
+}
+
+void TopologicalOrder::sortByIndex(std::vector<GraphNode*> *_nodes)
+{
+    IndexLess less;
+    less.m_index = &m_index;
+    std::sort(_nodes->begin(),_nodes->end(),less);
+}
+
+void TopologicalOrder::compact()
+{
+    std::vector<GraphNode*> nodes = order();
+    m_order.swap(nodes);
+    for (int i = 0; i < int(m_order.size()); i++)
+    {
+        m_index[m_order.at(i)] = i;
+    }
+    m_holes = 0;
+}
@@ -0,0 +1,227 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "UndoJournal.h"
+#include "GraphScene.h"
+
+// default history size, enough for a long session of ordinary edits
+#define DEFAULT_JOURNAL_BUDGET (4 * 1024 * 1024)
+
+UndoJournal::UndoJournal(GraphScene *_scene)
+{
+    m_scene = _scene;
+    m_budget = DEFAULT_JOURNAL_BUDGET;
+    m_usage = 0;
+    m_suspended = 0;
+    m_sealed = true;
+}
+
+void UndoJournal::record(const JournalEntry &_entry)
+{
+    if (!recording()) return;
+
+    // a new step means the undone steps can no longer be redone
+    for (int i = 0; i < int(m_redo.size()); i++)
+    {
+        m_usage -= m_redo.at(i).m_bytes;
+    }
+    m_redo.clear();
+
+    m_undo.push_back(_entry);
+    m_undo.back().m_bytes = measure(_entry);
+    m_usage += m_undo.back().m_bytes;
+    m_sealed = true;
+    trim();
+}
+
+void UndoJournal::recordRename(const JournalRename &_rename)
+{
+    if (!recording()) return;
+
+    // typing a name changes it on every key press, fold those into the step that started the edit
+    if (!m_sealed && m_redo.empty() && !m_undo.empty())
+    {
+        JournalEntry &last = m_undo.back();
+        if (last.m_renames.size() == 1 && last.m_renames.at(0).m_id == _rename.m_id)
+        {
+            last.m_renames.at(0).m_newName = _rename.m_newName;
+            last.m_renames.at(0).m_newShortName = _rename.m_newShortName;
+            m_usage -= last.m_bytes;
+            last.m_bytes = measure(last);
+            m_usage += last.m_bytes;
+            trim();
+            return;
+        }
+    }
+
+    JournalEntry entry;
+    entry.m_renames.push_back(_rename);
+    record(entry);
+    m_sealed = false;
+}
+
+bool UndoJournal::undo()
+{
+    if (m_undo.empty()) return false;
+
+    JournalEntry entry = m_undo.back();
+    m_undo.pop_back();
+    revert(entry);
+    m_redo.push_back(entry);
+    m_sealed = true;
+    return true;
+}
+
+bool UndoJournal::redo()
+{
+    if (m_redo.empty()) return false;
+
+    JournalEntry entry = m_redo.back();
+    m_redo.pop_back();
+    apply(entry);
+    m_undo.push_back(entry);
+    m_sealed = true;
+    return true;
+}
+
+void UndoJournal::clear()
+{
+    m_undo.clear();
+    m_redo.clear();
+    m_usage = 0;
+    m_sealed = true;
+}
+
+void UndoJournal::setByteBudget(qint64 _bytes)
+{
+    m_budget = _bytes;
+    trim();
+}
+
+void UndoJournal::revert(const JournalEntry &_entry)
+{
+    suspend();
+    m_scene->beginBatch();
+
+    for (int i = int(_entry.m_renames.size()) - 1; i >= 0; i--)
+    {
+        const JournalRename &rename = _entry.m_renames.at(i);
+        m_scene->renameNodeById(rename.m_id,rename.m_oldName,rename.m_oldShortName);
+    }
+    for (int i = int(_entry.m_moves.size()) - 1; i >= 0; i--)
+    {
+        m_scene->moveNodeById(_entry.m_moves.at(i).m_id,_entry.m_moves.at(i).m_from);
+    }
+    for (int i = int(_entry.m_addedEdges.size()) - 1; i >= 0; i--)
+    {
+        m_scene->disconnectById(_entry.m_addedEdges.at(i));
+    }
+    std::vector<quint32> created;
+    for (int i = 0; i < int(_entry.m_createdNodes.size()); i++)
+    {
+        created.push_back(_entry.m_createdNodes.at(i).m_id);
+    }
+    m_scene->removeNodesById(created);
+    for (int i = 0; i < int(_entry.m_removedNodes.size()); i++)
+    {
+        m_scene->restoreNode(_entry.m_removedNodes.at(i));
+    }
+    for (int i = 0; i < int(_entry.m_removedEdges.size()); i++)
+    {
+        m_scene->connectById(_entry.m_removedEdges.at(i));
+    }
+
+    m_scene->endBatch();
+    resume();
+}
+
+void UndoJournal::apply(const JournalEntry &_entry)
+{
+    suspend();
+    m_scene->beginBatch();
+
+    for (int i = 0; i < int(_entry.m_createdNodes.size()); i++)
+    {
+        m_scene->restoreNode(_entry.m_createdNodes.at(i));
+    }
+    for (int i = 0; i < int(_entry.m_addedEdges.size()); i++)
+    {
+        m_scene->connectById(_entry.m_addedEdges.at(i));
+    }
+    for (int i = 0; i < int(_entry.m_removedEdges.size()); i++)
+    {
+        m_scene->disconnectById(_entry.m_removedEdges.at(i));
+    }
+    std::vector<quint32> removed;
+    for (int i = 0; i < int(_entry.m_removedNodes.size()); i++)
+    {
+        removed.push_back(_entry.m_removedNodes.at(i).m_id);
+    }
+    m_scene->removeNodesById(removed);
+    for (int i = 0; i < int(_entry.m_moves.size()); i++)
+    {
+        m_scene->moveNodeById(_entry.m_moves.at(i).m_id,_entry.m_moves.at(i).m_to);
+    }
+    for (int i = 0; i < int(_entry.m_renames.size()); i++)
+    {
+        const JournalRename &rename = _entry.m_renames.at(i);
+        m_scene->renameNodeById(rename.m_id,rename.m_newName,rename.m_newShortName);
+    }
+
+    m_scene->endBatch();
+    resume();
+}
+
+void UndoJournal::trim()
+{
+    // drop the oldest undo steps first, then the furthest redo steps
+    while (m_usage > m_budget && !m_undo.empty())
+    {
+        m_usage -= m_undo.front().m_bytes;
+        m_undo.pop_front();
+    }
+    while (m_usage > m_budget && !m_redo.empty())
+    {
+        m_usage -= m_redo.front().m_bytes;
+        m_redo.pop_front();
+    }
+}
+
+qint64 UndoJournal::measure(const JournalEntry &_entry)
+{
+    qint64 bytes = sizeof(JournalEntry);
+    bytes += qint64(_entry.m_addedEdges.size() + _entry.m_removedEdges.size()) * sizeof(JournalEdge);
+    bytes += qint64(_entry.m_moves.size()) * sizeof(JournalMove);
+
+    for (int i = 0; i < int(_entry.m_createdNodes.size()); i++)
+    {
+        const SubgraphNode &record = _entry.m_createdNodes.at(i).m_record;
+        bytes += sizeof(JournalNode) + record.m_name.size() + record.m_shortName.size();
+    }
+    for (int i = 0; i < int(_entry.m_removedNodes.size()); i++)
+    {
+        const SubgraphNode &record = _entry.m_removedNodes.at(i).m_record;
+        bytes += sizeof(JournalNode) + record.m_name.size() + record.m_shortName.size();
+    }
+    for (int i = 0; i < int(_entry.m_renames.size()); i++)
+    {
+        const JournalRename &rename = _entry.m_renames.at(i);
+        bytes += sizeof(JournalRename) + rename.m_oldName.size() + rename.m_newName.size() +
+                 rename.m_oldShortName.size() + rename.m_newShortName.size();
+    }
+    return bytes;
+}
@@ -17,105 +17,208 @@
 
 #include "Utilities.h"
 
-std::string GenUtils::nodeTypeToString(NODE_TYPE _type)
+#include <array>
+
+// size of the string to type lookup tables, both must be a power of two
+#define NODE_TABLE_SIZE 128
+#define VALUE_TABLE_SIZE 8
+
+namespace
 {
-    switch (_type)
+    /// @brief Names indexed by NODE_TYPE, NT_NOTYPE takes the name returned for anything unknown
+    constexpr std::string_view s_nodeTypeNames[NT_ENDNODE+1] =
+    {
+        "__invalid_type__",
+        "String",
+        "Integer",
+        "Float",
+        "Double",
+        "Boolean",
+        "Character",
+        "Vector",
+        "Matrix",
+        "Angle Unit",
+        "Distance Unit",
+        "Time Unit",
+        "Last Value Unit",
+        "Compound Attribute",
+        "Enum Attribute",
+        "Generic Attribute",
+        "Matrix Attribute",
+        "Message Attribute",
+        "Boolean Numeric",
+        "One Byte Numeric",
+        "One Char Numeric",
+        "One Short Numeric",
+        "Two Shorts Numeric",
+        "Three Shorts Numeric",
+        "One Long Numeric",
+        "One Int Numeric",
+        "Two Longs Numeric",
+        "Two Ints Numeric",
+        "Three Longs Numeric",
+        "Three Ints Numeric",
+        "One Float Numeric",
+        "Two Floats Numeric",
+        "Three Floats Numeric",
+        "One Double Numeric",
+        "Two Doubles Numeric",
+        "Three Doubles Numeric",
+        "Four Doubles Numeric",
+        "Address Numeric",
+        "Last Value Numeric",
+        "__end_node__"
+    };
+    // catches a type added to the enum without a name here
+    static_assert(s_nodeTypeNames[NT_ENDNODE] == "__end_node__", "s_nodeTypeNames is out of step with NODE_TYPE");
+
+    /// @brief Names indexed by VALUE_TYPE, VT_NOTYPE takes the name returned for anything unknown
+    constexpr std::string_view s_valueTypeNames[VT_END+1] =
+    {
+        "__no_type__",
+        "OBJECT",
+        "ARGUMENT",
+        "MEMBER",
+        "END"
+    };
+    static_assert(s_valueTypeNames[VT_END] == "END", "s_valueTypeNames is out of step with VALUE_TYPE");
+
+    /// @brief Hash of the length and the first and eighth characters of a name, which between them tell every
+    /// known name apart, so a lookup costs the same however long the name is
+    /// @param [in] _name std::string_view - the name to hash
+    /// @param [in] _seed quint32 - the seed
+    /// @returns quint32
+    constexpr quint32 hashName(std::string_view _name, quint32 _seed)
+    {
+        quint32 key = quint32(_name.size());
+        if (_name.size() > 0) key |= quint32(quint8(_name[0])) << 8;
+        if (_name.size() > 7) key |= quint32(quint8(_name[7])) << 16;
+        // the low bits of a product only depend on the low bits, so take the slot from the middle
+        return ((key ^ _seed) * 2654435761u) >> 16;
+    }
+
+    /// @brief Check that no two names other than the first land in the same slot
+    /// @param [in] _names std::string_view[] - the names, index 0 is the unknown name and is left out
+    /// @param [in] _seed quint32 - the seed to try
+    /// @returns bool
+    template <size_t SIZE, size_t N>
+    constexpr bool seedIsPerfect(const std::string_view (&_names)[N], quint32 _seed)
     {
-        case(NT_BOOLEAN): return "Boolean"; break;
-        case(NT_DOUBLE): return "Double"; break;
-        case(NT_FLOAT): return "Float"; break;
-        case(NT_INT): return "Integer"; break;
-        case(NT_STRING): return "String"; break;
-        case(NT_CHAR): return "Character"; break;
-        case(NT_VECTOR): return "Vector"; break;
-        case(NT_MATRIX): return "Matrix"; break;
-        case(NT_OBJ_ANGLE): return "Angle Unit"; break;
-        case(NT_OBJ_DISTANCE): return "Distance Unit"; break;
-        case(NT_OBJ_TIME): return "Time Unit"; break;
-        case(NT_OBJ_LAST): return "Last Value Unit"; break;
-        case(NT_OBJ_COMPOUND): return "Compound Attribute"; break;
-        case(NT_OBJ_ENUM): return "Enum Attribute"; break;
-        case(NT_OBJ_GENERIC): return "Generic Attribute"; break;
-        case(NT_OBJ_MATRIX): return "Matrix Attribute"; break;
-        case(NT_OBJ_MESSAGE): return "Message Attribute"; break;
-        case(NT_OBJ_BOOLEAN): return "Boolean Numeric"; break;
-        case(NT_OBJ_ONEBYTE): return "One Byte Numeric"; break;
-        case(NT_OBJ_ONECHAR): return "One Char Numeric"; break;
-        case(NT_OBJ_ONESHORT): return "One Short Numeric"; break;
-        case(NT_OBJ_TWOSHORT): return "Two Shorts Numeric"; break;
-        case(NT_OBJ_THREESHORT): return "Three Shorts Numeric"; break;
-        case(NT_OBJ_ONELONG): return "One Long Numeric"; break;
-        case(NT_OBJ_ONEINT): return "One Int Numeric"; break;
-        case(NT_OBJ_TWOLONG): return "Two Longs Numeric"; break;
-        case(NT_OBJ_TWOINT): return "Two Ints Numeric"; break;
-        case(NT_OBJ_THREELONG): return "Three Longs Numeric"; break;
-        case(NT_OBJ_THREEINT): return "Three Ints Numeric"; break;
-        case(NT_OBJ_ONEFLOAT): return "One Float Numeric"; break;
-        case(NT_OBJ_TWOFLOAT): return "Two Floats Numeric"; break;
-        case(NT_OBJ_THREEFLOAT): return "Three Floats Numeric"; break;
-        case(NT_OBJ_ONEDOUBLE): return "One Double Numeric"; break;
-        case(NT_OBJ_TWODOUBLE): return "Two Doubles Numeric"; break;
-        case(NT_OBJ_THREEDOUBLE): return "Three Doubles Numeric"; break;
-        case(NT_OBJ_FOURDOUBLE): return "Four Doubles Numeric"; break;
-        case(NT_OBJ_ADDRESS): return "Address Numeric"; break;
-        case(NT_OBJ_NUM_LAST): return "Last Value Numeric"; break;
-        case(NT_ENDNODE): return "__end_node__"; break;
-        default: return "__invalid_type__"; break;
+        static_assert((SIZE & (SIZE-1)) == 0, "lookup tables must be a power of two");
+        static_assert(N <= SIZE && N <= 256, "lookup table too small for the names");
+        bool used[SIZE] = {};
+        for (size_t i = 1; i < N; i++)
+        {
+            quint32 slot = hashName(_names[i],_seed) & (SIZE-1);
+            if (used[slot]) return false;
+            used[slot] = true;
+        }
+        return true;
     }
+
+    /// @brief Find the first seed that gives every name its own slot
+    /// @param [in] _names std::string_view[] - the names
+    /// @returns quint32 - the seed, or ~0u if none was found
+    template <size_t SIZE, size_t N>
+    constexpr quint32 findSeed(const std::string_view (&_names)[N])
+    {
+        for (quint32 seed = 0; seed < 4096; seed++)
+        {
+            if (seedIsPerfect<SIZE>(_names,seed)) return seed;
+        }
+        return ~0u;
+    }
+
+    /// @brief Build the slot to type table, empty slots hold 0 which is the unknown type of both enums
+    /// @param [in] _names std::string_view[] - the names
+    /// @param [in] _seed quint32 - a seed found by findSeed
+    /// @returns std::array<quint8,SIZE>
+    template <size_t SIZE, size_t N>
+    constexpr std::array<quint8,SIZE> buildTable(const std::string_view (&_names)[N], quint32 _seed)
+    {
+        std::array<quint8,SIZE> table = {};
+        for (size_t i = 1; i < N; i++)
+        {
+            table[hashName(_names[i],_seed) & (SIZE-1)] = quint8(i);
+        }
+        return table;
+    }
+
+    constexpr quint32 s_nodeSeed = findSeed<NODE_TABLE_SIZE>(s_nodeTypeNames);
+    static_assert(s_nodeSeed != ~0u, "no perfect hash seed for the node type names");
+    constexpr std::array<quint8,NODE_TABLE_SIZE> s_nodeTable = buildTable<NODE_TABLE_SIZE>(s_nodeTypeNames,s_nodeSeed);
+
+    constexpr quint32 s_valueSeed = findSeed<VALUE_TABLE_SIZE>(s_valueTypeNames);
+    static_assert(s_valueSeed != ~0u, "no perfect hash seed for the value type names");
+    constexpr std::array<quint8,VALUE_TABLE_SIZE> s_valueTable = buildTable<VALUE_TABLE_SIZE>(s_valueTypeNames,s_valueSeed);
 }
 
-NODE_TYPE GenUtils::nodeStringToType(std::string _type)
+std::string_view GenUtils::nodeTypeToString(NODE_TYPE _type)
 {
-    if (_type == "Boolean") return NT_BOOLEAN;
-    else if (_type == "Double") return NT_DOUBLE;
-    else if (_type == "Float") return NT_FLOAT;
-    else if (_type == "Integer") return NT_INT;
-    else if (_type == "String") return NT_STRING;
-    else if (_type == "Character") return NT_CHAR;
-    else if (_type == "Vector") return NT_VECTOR;
-    else if (_type == "Matrix") return NT_MATRIX;
-    else if (_type == "Angle Unit") return NT_OBJ_ANGLE;
-    else if (_type == "Distance Unit") return NT_OBJ_DISTANCE;
-    else if (_type == "Time Unit") return NT_OBJ_TIME;
-    else if (_type == "Last Value Unit") return NT_OBJ_LAST;
-    else if (_type == "Compound Attribute") return NT_OBJ_COMPOUND;
-    else if (_type == "Enum Attribute") return NT_OBJ_ENUM;
-    else if (_type == "Generic Attribute") return NT_OBJ_GENERIC;
-    else if (_type == "Matrix Attribute") return NT_OBJ_MATRIX;
-    else if (_type == "Message Attribute") return NT_OBJ_MESSAGE;
-    else if (_type == "Boolean Numeric") return NT_OBJ_BOOLEAN;
-    else if (_type == "One Byte Numeric") return NT_OBJ_ONEBYTE;
-    else if (_type == "One Char Numeric") return NT_OBJ_ONECHAR;
-    else if (_type == "One Short Numeric") return NT_OBJ_ONESHORT;
-    else if (_type == "Two Shorts Numeric") return NT_OBJ_TWOSHORT;
-    else if (_type == "Three Shorts Numeric") return NT_OBJ_THREESHORT;
-    else if (_type == "One Long Numeric") return NT_OBJ_ONELONG;
-    else if (_type == "One Int Numeric") return NT_OBJ_ONEINT;
-    else if (_type == "Two Longs Numeric") return NT_OBJ_TWOLONG;
-    else if (_type == "Two Ints Numeric") return NT_OBJ_TWOINT;
-    else if (_type == "Three Longs Numeric") return NT_OBJ_THREELONG;
-    else if (_type == "Three Ints Numeric") return NT_OBJ_THREEINT;
-    else if (_type == "One Float Numeric") return NT_OBJ_ONEFLOAT;
-    else if (_type == "Two Floats Numeric") return NT_OBJ_TWOFLOAT;
-    else if (_type == "Three Floats Numeric") return NT_OBJ_THREEFLOAT;
-    else if (_type == "One Double Numeric") return NT_OBJ_ONEDOUBLE;
-    else if (_type == "Two Doubles Numeric") return NT_OBJ_TWODOUBLE;
-    else if (_type == "Three Doubles Numeric") return NT_OBJ_THREEDOUBLE;
-    else if (_type == "Four Doubles Numeric") return NT_OBJ_FOURDOUBLE;
-    else if (_type == "Address Numeric") return NT_OBJ_ADDRESS;
-    else if (_type == "Last Value Numeric") return NT_OBJ_NUM_LAST;
-    else if (_type == "__end_node__") return NT_ENDNODE;
-    else return NT_NOTYPE;
+    if (unsigned(_type) > unsigned(NT_ENDNODE)) return s_nodeTypeNames[NT_NOTYPE];
+    return s_nodeTypeNames[_type];
 }
 
-std::string GenUtils::valueTypeToString(VALUE_TYPE _type)
+NODE_TYPE GenUtils::nodeStringToType(std::string_view _type)
 {
-    switch(_type)
+    // each known name has its own slot so one comparison tells if this is it
+    int index = s_nodeTable[hashName(_type,s_nodeSeed) & (NODE_TABLE_SIZE-1)];
+    if (index == NT_NOTYPE || s_nodeTypeNames[index] != _type) return NT_NOTYPE;
+    return NODE_TYPE(index);
+}
+
+std::string_view GenUtils::valueTypeToString(VALUE_TYPE _type)
+{
+    if (unsigned(_type) > unsigned(VT_END)) return s_valueTypeNames[VT_NOTYPE];
+    return s_valueTypeNames[_type];
+}
+
+VALUE_TYPE GenUtils::valueStringToType(std::string_view _type)
+{
+    int index = s_valueTable[hashName(_type,s_valueSeed) & (VALUE_TABLE_SIZE-1)];
+    if (index == VT_NOTYPE || s_valueTypeNames[index] != _type) return VT_NOTYPE;
+    return VALUE_TYPE(index);
+}
+
+bool GenUtils::tokensUnique(const std::vector<std::string> &_tokens)
+{
+    // node types will always follow a -- so when one of these is found, skip the next
+    int count = 0;
+    int countj = 0;
+
+    while (countj < int(_tokens.size()))
     {
-        case(VT_OBJECT): return "OBJECT"; break;
-        case(VT_ARGUMENTS): return "ARGUMENT"; break;
-        case(VT_MEMBER): return "MEMBER"; break;
-        case(VT_END): return "END"; break;
-        default: return "__no_type__"; break;
+        if (_tokens.at(countj) == "--;")
+        {
+            countj +=2;
+        }
+        else
+        {
+            while (count < int(_tokens.size()))
+            {
+                if (countj != count)
+                {
+                    if (_tokens.at(count) == "--;")
+                    {
+                        count += 2;
+                    }
+                    else
+                    {
+                        if (_tokens.at(countj) == _tokens.at(count))
+                        {
+                            return false;
+                        }
+                        count++;
+                    }
+                }
+                else
+                {
+                    count++;
+                }
+            }
+            count = 0;
+            countj++;
+        }
     }
+    return true;
 }
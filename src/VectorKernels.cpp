@@ -0,0 +1,355 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "VectorKernels.h"
+
+#include <QElapsedTimer>
+
+#include <string.h>
+#include <vector>
+
+#ifdef __SSE3__
+#include <pmmintrin.h>
+#endif
+
+// number of values compared by verify
+#define VERIFY_COUNT 256
+
+// the scalar kernels use the same operations in the same order as the SSE ones so the results match exactly
+
+void VectorKernels::addScalar(const PortVector *_a, const PortVector *_b, PortVector *_out, int _count)
+{
+    for (int i = 0; i < _count; i++)
+    {
+        for (int j = 0; j < 4; j++)
+        {
+            _out[i].m_v[j] = _a[i].m_v[j] + _b[i].m_v[j];
+        }
+    }
+}
+
+void VectorKernels::scaleScalar(const PortVector *_a, double _scale, PortVector *_out, int _count)
+{
+    for (int i = 0; i < _count; i++)
+    {
+        for (int j = 0; j < 4; j++)
+        {
+            _out[i].m_v[j] = _a[i].m_v[j] * _scale;
+        }
+    }
+}
+
+void VectorKernels::dotScalar(const PortVector *_a, const PortVector *_b, double *_out, int _count)
+{
+    for (int i = 0; i < _count; i++)
+    {
+        double p0 = _a[i].m_v[0] * _b[i].m_v[0];
+        double p1 = _a[i].m_v[1] * _b[i].m_v[1];
+        double p2 = _a[i].m_v[2] * _b[i].m_v[2];
+        double p3 = _a[i].m_v[3] * _b[i].m_v[3];
+        // paired the way two horizontal adds pair them
+        _out[i] = (p0 + p1) + (p2 + p3);
+    }
+}
+
+void VectorKernels::crossScalar(const PortVector *_a, const PortVector *_b, PortVector *_out, int _count)
+{
+    for (int i = 0; i < _count; i++)
+    {
+        const double *a = _a[i].m_v;
+        const double *b = _b[i].m_v;
+        _out[i].m_v[0] = a[1] * b[2] - a[2] * b[1];
+        _out[i].m_v[1] = a[2] * b[0] - a[0] * b[2];
+        _out[i].m_v[2] = a[0] * b[1] - a[1] * b[0];
+        _out[i].m_v[3] = 0.0;
+    }
+}
+
+void VectorKernels::multiplyScalar(const PortMatrix *_a, const PortMatrix *_b, PortMatrix *_out, int _count)
+{
+    for (int i = 0; i < _count; i++)
+    {
+        const double *a = _a[i].m_m;
+        const double *b = _b[i].m_m;
+        double *out = _out[i].m_m;
+        for (int row = 0; row < 4; row++)
+        {
+            for (int col = 0; col < 4; col++)
+            {
+                double sum = a[row*4] * b[col];
+                sum = sum + a[row*4+1] * b[4+col];
+                sum = sum + a[row*4+2] * b[8+col];
+                sum = sum + a[row*4+3] * b[12+col];
+                out[row*4+col] = sum;
+            }
+        }
+    }
+}
+
+void VectorKernels::transformScalar(const PortVector *_v, const PortMatrix *_m, PortVector *_out, int _count)
+{
+    for (int i = 0; i < _count; i++)
+    {
+        const double *v = _v[i].m_v;
+        const double *m = _m[i].m_m;
+        for (int col = 0; col < 4; col++)
+        {
+            double sum = v[0] * m[col];
+            sum = sum + v[1] * m[4+col];
+            sum = sum + v[2] * m[8+col];
+            sum = sum + v[3] * m[12+col];
+            _out[i].m_v[col] = sum;
+        }
+    }
+}
+
+#ifdef __SSE3__
+
+// every vector is two registers of two doubles, components 0 and 1 then 2 and 3
+
+void VectorKernels::add(const PortVector *_a, const PortVector *_b, PortVector *_out, int _count)
+{
+    for (int i = 0; i < _count; i++)
+    {
+        _mm_store_pd(_out[i].m_v,_mm_add_pd(_mm_load_pd(_a[i].m_v),_mm_load_pd(_b[i].m_v)));
+        _mm_store_pd(_out[i].m_v + 2,_mm_add_pd(_mm_load_pd(_a[i].m_v + 2),_mm_load_pd(_b[i].m_v + 2)));
+    }
+}
+
+void VectorKernels::scale(const PortVector *_a, double _scale, PortVector *_out, int _count)
+{
+    __m128d s = _mm_set1_pd(_scale);
+    for (int i = 0; i < _count; i++)
+    {
+        _mm_store_pd(_out[i].m_v,_mm_mul_pd(_mm_load_pd(_a[i].m_v),s));
+        _mm_store_pd(_out[i].m_v + 2,_mm_mul_pd(_mm_load_pd(_a[i].m_v + 2),s));
+    }
+}
+
+void VectorKernels::dot(const PortVector *_a, const PortVector *_b, double *_out, int _count)
+{
+    for (int i = 0; i < _count; i++)
+    {
+        __m128d p01 = _mm_mul_pd(_mm_load_pd(_a[i].m_v),_mm_load_pd(_b[i].m_v));
+        __m128d p23 = _mm_mul_pd(_mm_load_pd(_a[i].m_v + 2),_mm_load_pd(_b[i].m_v + 2));
+        __m128d sum = _mm_hadd_pd(p01,p23);
+        sum = _mm_hadd_pd(sum,sum);
+        _out[i] = _mm_cvtsd_f64(sum);
+    }
+}
+
+void VectorKernels::cross(const PortVector *_a, const PortVector *_b, PortVector *_out, int _count)
+{
+    for (int i = 0; i < _count; i++)
+    {
+        __m128d axy = _mm_load_pd(_a[i].m_v);
+        __m128d azw = _mm_load_pd(_a[i].m_v + 2);
+        __m128d bxy = _mm_load_pd(_b[i].m_v);
+        __m128d bzw = _mm_load_pd(_b[i].m_v + 2);
+        __m128d ayz = _mm_shuffle_pd(axy,azw,1);
+        __m128d azx = _mm_shuffle_pd(azw,axy,0);
+        __m128d byz = _mm_shuffle_pd(bxy,bzw,1);
+        __m128d bzx = _mm_shuffle_pd(bzw,bxy,0);
+        __m128d ayx = _mm_shuffle_pd(axy,axy,1);
+        __m128d byx = _mm_shuffle_pd(bxy,bxy,1);
+        _mm_store_pd(_out[i].m_v,_mm_sub_pd(_mm_mul_pd(ayz,bzx),_mm_mul_pd(azx,byz)));
+        // the low half is the third component, the fourth is cleared
+        __m128d z = _mm_sub_pd(_mm_mul_pd(axy,byx),_mm_mul_pd(ayx,bxy));
+        _mm_store_pd(_out[i].m_v + 2,_mm_move_sd(_mm_setzero_pd(),z));
+    }
+}
+
+void VectorKernels::multiply(const PortMatrix *_a, const PortMatrix *_b, PortMatrix *_out, int _count)
+{
+    for (int i = 0; i < _count; i++)
+    {
+        const double *a = _a[i].m_m;
+        const double *b = _b[i].m_m;
+        for (int row = 0; row < 4; row++)
+        {
+            // each row of the product is the rows of b weighted by a row of a, done a half row at a time
+            for (int half = 0; half < 4; half += 2)
+            {
+                __m128d sum = _mm_mul_pd(_mm_set1_pd(a[row*4]),_mm_load_pd(b + half));
+                sum = _mm_add_pd(sum,_mm_mul_pd(_mm_set1_pd(a[row*4+1]),_mm_load_pd(b + 4 + half)));
+                sum = _mm_add_pd(sum,_mm_mul_pd(_mm_set1_pd(a[row*4+2]),_mm_load_pd(b + 8 + half)));
+                sum = _mm_add_pd(sum,_mm_mul_pd(_mm_set1_pd(a[row*4+3]),_mm_load_pd(b + 12 + half)));
+                _mm_store_pd(_out[i].m_m + row*4 + half,sum);
+            }
+        }
+    }
+}
+
+void VectorKernels::transform(const PortVector *_v, const PortMatrix *_m, PortVector *_out, int _count)
+{
+    for (int i = 0; i < _count; i++)
+    {
+        const double *v = _v[i].m_v;
+        const double *m = _m[i].m_m;
+        for (int half = 0; half < 4; half += 2)
+        {
+            __m128d sum = _mm_mul_pd(_mm_set1_pd(v[0]),_mm_load_pd(m + half));
+            sum = _mm_add_pd(sum,_mm_mul_pd(_mm_set1_pd(v[1]),_mm_load_pd(m + 4 + half)));
+            sum = _mm_add_pd(sum,_mm_mul_pd(_mm_set1_pd(v[2]),_mm_load_pd(m + 8 + half)));
+            sum = _mm_add_pd(sum,_mm_mul_pd(_mm_set1_pd(v[3]),_mm_load_pd(m + 12 + half)));
+            _mm_store_pd(_out[i].m_v + half,sum);
+        }
+    }
+}
+
+bool VectorKernels::simd()
+{
+    return true;
+}
+
+#else
+
+// without SSE3 every kernel is its scalar version
+
+void VectorKernels::add(const PortVector *_a, const PortVector *_b, PortVector *_out, int _count)
+{
+    addScalar(_a,_b,_out,_count);
+}
+
+void VectorKernels::scale(const PortVector *_a, double _scale, PortVector *_out, int _count)
+{
+    scaleScalar(_a,_scale,_out,_count);
+}
+
+void VectorKernels::dot(const PortVector *_a, const PortVector *_b, double *_out, int _count)
+{
+    dotScalar(_a,_b,_out,_count);
+}
+
+void VectorKernels::cross(const PortVector *_a, const PortVector *_b, PortVector *_out, int _count)
+{
+    crossScalar(_a,_b,_out,_count);
+}
+
+void VectorKernels::multiply(const PortMatrix *_a, const PortMatrix *_b, PortMatrix *_out, int _count)
+{
+    multiplyScalar(_a,_b,_out,_count);
+}
+
+void VectorKernels::transform(const PortVector *_v, const PortMatrix *_m, PortVector *_out, int _count)
+{
+    transformScalar(_v,_m,_out,_count);
+}
+
+bool VectorKernels::simd()
+{
+    return false;
+}
+
+#endif
+
+// fills an array with repeatable values spread over a few orders of magnitude, carrying the seed on
+static void fillValues(double *_values, int _count, unsigned int *_seed)
+{
+    for (int i = 0; i < _count; i++)
+    {
+        *_seed = *_seed * 1103515245u + 12345u;
+        _values[i] = (double((*_seed >> 8) & 0xffff) - 32768.0) / double(1 + (*_seed & 0xff));
+    }
+}
+
+// each vector is filled through its own array, never past the end of it into the next
+static void fillVectors(std::vector<PortVector> *_vectors, unsigned int _seed)
+{
+    for (int i = 0; i < int(_vectors->size()); i++)
+    {
+        fillValues((*_vectors)[i].m_v,4,&_seed);
+    }
+}
+
+static void fillMatrices(std::vector<PortMatrix> *_matrices, unsigned int _seed)
+{
+    for (int i = 0; i < int(_matrices->size()); i++)
+    {
+        fillValues((*_matrices)[i].m_m,16,&_seed);
+    }
+}
+
+bool VectorKernels::verify()
+{
+    std::vector<PortVector> a(VERIFY_COUNT), b(VERIFY_COUNT), fast(VERIFY_COUNT), slow(VERIFY_COUNT);
+    std::vector<PortMatrix> ma(VERIFY_COUNT), mb(VERIFY_COUNT), mfast(VERIFY_COUNT), mslow(VERIFY_COUNT);
+    std::vector<double> dfast(VERIFY_COUNT), dslow(VERIFY_COUNT);
+    fillVectors(&a,1);
+    fillVectors(&b,2);
+    fillMatrices(&ma,3);
+    fillMatrices(&mb,4);
+
+    size_t vectorBytes = sizeof(PortVector) * VERIFY_COUNT;
+    size_t matrixBytes = sizeof(PortMatrix) * VERIFY_COUNT;
+
+    add(&a[0],&b[0],&fast[0],VERIFY_COUNT);
+    addScalar(&a[0],&b[0],&slow[0],VERIFY_COUNT);
+    if (memcmp(&fast[0],&slow[0],vectorBytes) != 0) return false;
+
+    scale(&a[0],0.37,&fast[0],VERIFY_COUNT);
+    scaleScalar(&a[0],0.37,&slow[0],VERIFY_COUNT);
+    if (memcmp(&fast[0],&slow[0],vectorBytes) != 0) return false;
+
+    dot(&a[0],&b[0],&dfast[0],VERIFY_COUNT);
+    dotScalar(&a[0],&b[0],&dslow[0],VERIFY_COUNT);
+    if (memcmp(&dfast[0],&dslow[0],sizeof(double) * VERIFY_COUNT) != 0) return false;
+
+    cross(&a[0],&b[0],&fast[0],VERIFY_COUNT);
+    crossScalar(&a[0],&b[0],&slow[0],VERIFY_COUNT);
+    if (memcmp(&fast[0],&slow[0],vectorBytes) != 0) return false;
+
+    multiply(&ma[0],&mb[0],&mfast[0],VERIFY_COUNT);
+    multiplyScalar(&ma[0],&mb[0],&mslow[0],VERIFY_COUNT);
+    if (memcmp(&mfast[0],&mslow[0],matrixBytes) != 0) return false;
+
+    transform(&a[0],&ma[0],&fast[0],VERIFY_COUNT);
+    transformScalar(&a[0],&ma[0],&slow[0],VERIFY_COUNT);
+    if (memcmp(&fast[0],&slow[0],vectorBytes) != 0) return false;
+
+    return true;
+}
+
+double VectorKernels::benchmark(int _count, int _repeats)
+{
+    if (_count <= 0 || _repeats <= 0) return 0.0;
+
+    std::vector<PortVector> a(_count), b(_count), out(_count);
+    std::vector<PortMatrix> ma(_count), mb(_count), mout(_count);
+    std::vector<double> d(_count);
+    fillVectors(&a,5);
+    fillVectors(&b,6);
+    fillMatrices(&ma,7);
+    fillMatrices(&mb,8);
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < _repeats; i++)
+    {
+        add(&a[0],&b[0],&out[0],_count);
+        scale(&a[0],0.5,&out[0],_count);
+        dot(&a[0],&b[0],&d[0],_count);
+        cross(&a[0],&b[0],&out[0],_count);
+        multiply(&ma[0],&mb[0],&mout[0],_count);
+        transform(&a[0],&ma[0],&out[0],_count);
+    }
+    qint64 elapsed = timer.nsecsElapsed();
+    if (elapsed <= 0) return 0.0;
+
+    // six kernels each over every value
+    return double(_count) * double(_repeats) * 6.0 * 1.0e9 / double(elapsed);
+}
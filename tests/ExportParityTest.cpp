@@ -0,0 +1,180 @@
+/*
+  Copyright (C) 2014 Callum James
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "GraphScene.h"
+#include "GraphExport.h"
+#include "Subgraph.h"
+
+#include <QtTest/QtTest>
+#include <QDir>
+
+/// @file ExportParityTest.cpp
+/// @brief Checks the scene, its worker thread export and the command line tool export the same string
+/// @author Callum James
+/// @version 1.0
+/// @date 19/10/2026
+/// Revision History:
+/// Initial Version 19/10/2026
+/// @class ExportParityTest
+/// @brief Builds graphs in a scene that is never shown, exports them with GraphScene::collectInformation and again
+/// with GraphScene::collectInformationAsync or from the saved file with GraphExport::exportGraph as nodegraph-cli
+/// does, and compares the strings.
+/// Run with QT_QPA_PLATFORM=offscreen where there is no display.
+
+class ExportParityTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /// @brief A node fed by several edges, joined in a different order to the one the sources were created in
+    void severalInboundEdges();
+    /// @brief Member nodes removed and added again, so the worker thread's copy reuses the freed records
+    void removeThenAdd();
+    /// @brief An unnamed node upstream of the end node, both exports leave out everything upstream
+    void incompleteUpstream();
+
+private:
+    /// @brief Make the record of a named node with one socket each way
+    /// @param [in] _valueTy VALUE_TYPE - top level type of the node
+    /// @param [in] _type NODE_TYPE - bottom level type of the node
+    /// @param [in] _name std::string - the name and short name of the node
+    /// @param [in] _x qreal - how far along the node is placed
+    /// @returns SubgraphNode
+    SubgraphNode record(VALUE_TYPE _valueTy, NODE_TYPE _type, const std::string &_name, qreal _x);
+    /// @brief Export a scene on the calling thread and on a worker thread and compare the two
+    /// @param [in] _scene GraphScene* - the scene
+    void compareAsync(GraphScene *_scene);
+};
+
+SubgraphNode ExportParityTest::record(VALUE_TYPE _valueTy, NODE_TYPE _type, const std::string &_name, qreal _x)
+{
+    SubgraphNode node;
+    node.m_valueType = _valueTy;
+    node.m_nodeType = _type;
+    node.m_point = QPointF(_x,0.0);
+    node.m_width = 150.0;
+    node.m_baseWidth = 150.0;
+    node.m_editable = true;
+    node.m_deletable = true;
+    // members connect to nothing, as when created from the menus
+    node.m_numInbound = _valueTy == VT_MEMBER ? 0 : 1;
+    node.m_numOutbound = _valueTy == VT_MEMBER ? 0 : 1;
+    node.m_name = _name;
+    node.m_shortName = _name;
+    return node;
+}
+
+void ExportParityTest::severalInboundEdges()
+{
+    GraphScene scene;
+    scene.init();
+    scene.addEndNode("end");
+
+    std::vector<GraphNode*> before;
+    GraphNode *end = NULL;
+    QVERIFY(scene.exportedNodes(&before,&end));
+
+    // every node carries text so each edge below passes the port check
+    Subgraph graph;
+    graph.addNode(record(VT_OBJECT,NT_OBJ_MESSAGE,"message",0.0));
+    graph.addNode(record(VT_ARGUMENTS,NT_STRING,"text",200.0));
+    graph.addNode(record(VT_ARGUMENTS,NT_CHAR,"letter",400.0));
+    graph.addNode(record(VT_OBJECT,NT_OBJ_ENUM,"choice",600.0));
+    graph.addNode(record(VT_MEMBER,NT_INT,"count",800.0));
+    std::vector<GraphNode*> nodes = scene.insertSubgraph(graph,QPointF(-1000.0,0.0));
+    QCOMPARE(int(nodes.size()),5);
+
+    // joined last to first so the order of the edges differs from the order of the nodes
+    GraphNode *message = nodes.at(0);
+    QVERIFY(scene.connectSockets(nodes.at(3)->outboundSocket(0),message->inboundSocket(0)) != NULL);
+    QVERIFY(scene.connectSockets(nodes.at(1)->outboundSocket(0),message->inboundSocket(0)) != NULL);
+    QVERIFY(scene.connectSockets(nodes.at(2)->outboundSocket(0),message->inboundSocket(0)) != NULL);
+    QVERIFY(scene.connectSockets(message->outboundSocket(0),end->inboundSocket(0)) != NULL);
+
+    std::string fromScene;
+    QVERIFY(scene.collectInformation(&fromScene));
+
+    QString fileName = QDir::temp().filePath("nodegraph-export-parity.ngr");
+    QVERIFY(scene.saveGraph(fileName));
+    Subgraph saved;
+    QVERIFY(saved.load(fileName));
+    QFile::remove(fileName);
+
+    std::string fromFile;
+    std::string error;
+    QVERIFY2(GraphExport::exportGraph(saved,&fromFile,&error),error.c_str());
+    QCOMPARE(QString::fromStdString(fromFile),QString::fromStdString(fromScene));
+}
+
+void ExportParityTest::compareAsync(GraphScene *_scene)
+{
+    std::string fromScene;
+    QVERIFY(_scene->collectInformation(&fromScene));
+
+    QFuture<ExportResult> future = _scene->collectInformationAsync();
+    future.waitForFinished();
+    ExportResult result = future.result();
+    QVERIFY2(result.m_ok,result.m_error.c_str());
+    QCOMPARE(QString::fromStdString(result.m_string),QString::fromStdString(fromScene));
+}
+
+void ExportParityTest::removeThenAdd()
+{
+    GraphScene scene;
+    scene.init();
+    scene.addEndNode("end");
+    std::vector<GraphNode*> before;
+    GraphNode *end = NULL;
+    QVERIFY(scene.exportedNodes(&before,&end));
+
+    Subgraph graph;
+    graph.addNode(record(VT_MEMBER,NT_INT,"first",0.0));
+    graph.addNode(record(VT_MEMBER,NT_FLOAT,"second",200.0));
+    graph.addNode(record(VT_MEMBER,NT_BOOLEAN,"third",400.0));
+    graph.addNode(record(VT_ARGUMENTS,NT_STRING,"text",600.0));
+    std::vector<GraphNode*> nodes = scene.insertSubgraph(graph,QPointF(-1000.0,0.0),end);
+    QCOMPARE(int(nodes.size()),4);
+    compareAsync(&scene);
+
+    // the node added last takes the record the first member gave up, but is exported after the others
+    std::vector<quint32> removed;
+    removed.push_back(nodes.at(0)->id());
+    QCOMPARE(scene.removeNodesById(removed),1);
+    Subgraph more;
+    more.addNode(record(VT_MEMBER,NT_DOUBLE,"fourth",0.0));
+    QCOMPARE(int(scene.insertSubgraph(more,QPointF(-1000.0,400.0)).size()),1);
+    compareAsync(&scene);
+}
+
+void ExportParityTest::incompleteUpstream()
+{
+    GraphScene scene;
+    scene.init();
+    scene.addEndNode("end");
+    std::vector<GraphNode*> before;
+    GraphNode *end = NULL;
+    QVERIFY(scene.exportedNodes(&before,&end));
+
+    Subgraph graph;
+    graph.addNode(record(VT_MEMBER,NT_INT,"count",0.0));
+    graph.addNode(record(VT_ARGUMENTS,NT_STRING,"",200.0));
+    QCOMPARE(int(scene.insertSubgraph(graph,QPointF(-1000.0,0.0),end).size()),2);
+    compareAsync(&scene);
+}
+
+QTEST_MAIN(ExportParityTest)
+#include "ExportParityTest.moc"
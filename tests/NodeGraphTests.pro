@@ -0,0 +1,32 @@
+TEMPLATE= app
+CONFIG += console testcase
+CONFIG -= app_bundle
+CONFIG += c++17
+TARGET=bin/nodegraph-tests
+
+OBJECTS_DIR = obj
+
+QT+= testlib widgets opengl gui core concurrent
+
+INC_DIR = ../include
+SRC_DIR = .
+LIB_DIR = ../lib
+
+INCLUDEPATH +=. $$INC_DIR ../ui
+
+unix:!macx{
+    DEFINES += LINUX
+}
+macx:{
+    DEFINES += DARWIN
+}
+
+QMAKE_CXXFLAGS_WARN_ON += "-Wno-unused-parameter"
+QMAKE_CXXFLAGS+= -msse -msse2 -msse3
+macx:QMAKE_CXXFLAGS+= -arch x86_64
+
+# the library has to be built first, the scene is created without being shown
+LIBS += -L$$LIB_DIR -lNodeGraph
+PRE_TARGETDEPS += $$LIB_DIR/libNodeGraph.a
+
+SOURCES +=  $$SRC_DIR/ExportParityTest.cpp